@@ -0,0 +1,126 @@
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Aggregation of the scores of a metasolution in each scenario into its score (see Policy::set_aggregator) :
+// max (the default), q-quantile, CVaR (mean of the scores from the q-quantile up) or mean.
+// The q-quantile is the score at position ceil(q * S) - 1 of the sorted scores (as MetaSolution::get_quantile).
+// Bounded evaluations stop once exceed_tolerance(S) scenarios are above the bound : the aggregate is then known to be above it.
+class Aggregator {
+public:
+    enum class Kind { MAX, QUANTILE, CVAR, MEAN };
+
+    Aggregator() {}
+    static Aggregator max() { return Aggregator(Kind::MAX, 1.0); }
+    static Aggregator quantile(double q) { return Aggregator(Kind::QUANTILE, checked_level(q)); }
+    static Aggregator cvar(double q) { return Aggregator(Kind::CVAR, checked_level(q)); }
+    static Aggregator mean() { return Aggregator(Kind::MEAN, 0.0); }
+
+    Kind get_kind() const { return kind; }
+    double get_level() const { return level; }
+
+    //position of the q-quantile in the sorted scores of S scenarios
+    static int quantile_index(double q, int S) {
+        if (S == 0) return 0;
+        int index = static_cast<int>(std::ceil(q * S)) - 1;
+        return std::min(std::max(index, 0), S - 1);
+    }
+
+    //aggregate of the scores (0 if there is none). O(S) : partial sort (nth_element) of a copy for the quantiles
+    int aggregate(const std::vector<int>& scores) const {
+        const int S = scores.size();
+        if (S == 0) return 0;
+        switch (kind) {
+            case Kind::MAX: {
+                int maxCost = 0; //sumci can't be negative
+                for (int score : scores) maxCost = std::max(maxCost, score);
+                return maxCost;
+            }
+            case Kind::MEAN: {
+                long long sum = 0;
+                for (int score : scores) sum += score;
+                return rounded_mean(sum, S);
+            }
+            default: {
+                std::vector<int>& work = buffer();
+                work.assign(scores.begin(), scores.end());
+                int index = quantile_index(level, S);
+                std::nth_element(work.begin(), work.begin() + index, work.end());
+                if (kind == Kind::QUANTILE) return work[index];
+                long long sum = 0; //after nth_element, the tail is the S - index largest scores
+                for (int i = index; i < S; i++) sum += work[i];
+                return rounded_mean(sum, S - index);
+            }
+        }
+    }
+
+    //aggregate of scores already sorted in increasing order (see MetaSolution::get_aggregate)
+    int aggregate_sorted(const std::vector<int>& sorted_scores) const {
+        const int S = sorted_scores.size();
+        if (S == 0) return 0;
+        switch (kind) {
+            case Kind::MAX: return std::max(0, sorted_scores.back());
+            case Kind::QUANTILE: return sorted_scores[quantile_index(level, S)];
+            default: {
+                int index = (kind == Kind::MEAN) ? 0 : quantile_index(level, S);
+                long long sum = 0;
+                for (int i = index; i < S; i++) sum += sorted_scores[i];
+                return rounded_mean(sum, S - index);
+            }
+        }
+    }
+
+    //scenario that sets the aggregate : the scenario at the quantile for QUANTILE, the worst scenario otherwise
+    int limiting_scenario(const std::vector<int>& scores) const {
+        int target = (kind == Kind::QUANTILE) ? aggregate(scores) : 0;
+        int limiting = 0;
+        int maxCost = 0;
+        for (int s = 0; s < static_cast<int>(scores.size()); s++) {
+            if (kind == Kind::QUANTILE) {
+                if (scores[s] == target) return s;
+            }
+            else if (scores[s] > maxCost) {
+                maxCost = scores[s];
+                limiting = s;
+            }
+        }
+        return limiting;
+    }
+
+    //number of scenarios above a bound that make the aggregate of S scenarios exceed it. Sufficient only for MEAN and CVAR (their aggregate can
+    //exceed the bound with fewer) : an evaluation that did not stop early still compares its aggregate to the bound (Policy::evaluate_meta_bounded)
+    int exceed_tolerance(int S) const {
+        switch (kind) {
+            case Kind::MAX: return 1;
+            case Kind::MEAN: return std::max(S, 1);
+            default: return std::max(1, S - quantile_index(level, S)); //the quantile (and the tail above it) is among them
+        }
+    }
+
+    bool operator==(const Aggregator& other) const { return kind == other.kind && level == other.level; }
+    bool operator!=(const Aggregator& other) const { return !(*this == other); }
+
+private:
+    Kind kind = Kind::MAX;
+    double level = 1.0; //q of the quantiles
+
+    Aggregator(Kind kind, double level) : kind(kind), level(level) {}
+
+    static double checked_level(double q) {
+        if (!(q > 0 && q <= 1)) throw std::invalid_argument("Quantile level must be in ]0, 1].");
+        return q;
+    }
+
+    static int rounded_mean(long long sum, int count) { return static_cast<int>((sum + count / 2) / count); }
+
+    static std::vector<int>& buffer() { //work copy of the scores, one per thread
+        thread_local std::vector<int> work;
+        return work;
+    }
+};
+
+#endif // AGGREGATOR_H
@@ -105,7 +105,7 @@ public:
 
                 // instance specific parameters declaration (even if common to several instances)
                 std::vector<int> dueDate = sm_instance.dueDates;
-                std::vector<std::vector<int>> releaseDate = sm_instance.releaseDates;
+                const ScenarioMatrix& releaseDate = sm_instance.releaseDates;
                 std::vector<int> duration = sm_instance.durations;
 
                 //Declaring the interval variables
@@ -297,7 +297,7 @@ public:
         int nbScenarios = sm_instance.getS();
         std::vector<uint8_t> prec = sm_instance.precedenceConstraints;
         std::vector<int> dueDate = sm_instance.dueDates;
-        std::vector<std::vector<int>> releaseDate= sm_instance.releaseDates;
+        const ScenarioMatrix& releaseDate = sm_instance.releaseDates;
         std::vector<int> duration = sm_instance.durations;
 
         char name[32]; // dummy variable to temporarily store name of elements
@@ -423,6 +423,8 @@ public:
             throw std::runtime_error("Initial solution is not of type SequenceMetaSolution!");
         }
 
+        ScenarioOrdering& ordering = instance.get_scenario_ordering(); //scenarios most likely to exceed the bound first (shared with the other runs on this instance)
+
         // Main loop: merge groups while improvement exists
         bool improvement = true;
         while (improvement) { //&& !timeLimitExceeded(startTime)
@@ -436,7 +438,13 @@ public:
 
             for (int i = 0; i < currentSolution->nb_groups()-1; ++i){//for every pair of group
                 GroupMetaSolution* candidateSolution = currentSolution->merge_groups(i);
-                int CandidateScore = policy->evaluate_meta(*candidateSolution, instance); // Note that Esswein's algorithm conserves precedence constraints compliance.
+                EvaluationResult result = policy->evaluate_meta_bounded(*candidateSolution, instance, bestCandidateScore, &ordering.order()); // Note that Esswein's algorithm conserves precedence constraints compliance.
+                if (!result.complete) { //worse than the best candidate : rejected
+                    ordering.record_trigger(result.trigger_scenario);
+                    delete candidateSolution;
+                    continue;
+                }
+                int CandidateScore = result.score;
                 int CandidatelargestGroupSize = candidateSolution->largest_group_size();
                 //std::cout <<"considering :";
                 //candidateSolution->print();
@@ -492,13 +500,7 @@ public:
             throw std::runtime_error("Initial solution is not of type SequenceMetaSolution!");
         }
 
-        std::vector<int> scenario_order(instance.getS()); //array given to solve_savesteps to prioritize scenarios more likely to trigger bound (scenario_order[0] : scenario to try first)
-        std::vector<int> position(instance.getS()); //reverse array giving (postion[0]: when to try scenario 0, or where it is in scenario_order)
-
-        for (int i = 0; i < instance.getS(); ++i) { //init arrays
-            scenario_order[i] = i;
-            position[i] = i;
-        }
+        ScenarioOrdering& ordering = instance.get_scenario_ordering(); //prioritizes scenarios more likely to trigger bound (shared by all seeds and algorithms on this instance)
 
         // Main loop: merge groups while improvement exists
         bool improvement = true;
@@ -517,22 +519,15 @@ public:
 
             for (int i = 0; i < currentSolution->nb_groups()-1; ++i){//for each group, try to merge with following and eval. However, use the eval that takes a bound
                 GroupMetaSolution* candidateSolution = currentSolution->merge_groups(i);
-                int CandidateScore ;
-
-                try {//note : could also start eval with scenarios most likely to yield big bound.
-                    CandidateScore = policy->evaluate_meta(*candidateSolution, instance, bestCandidateScore, &scenario_order); // Note that Esswein's algorithm conserves precedence constraints compliance(at least in extended form).
-                } catch (const EvaluationBoundExceeded& e) {
+                //note : could also start eval with scenarios most likely to yield big bound.
+                EvaluationResult result = policy->evaluate_meta_bounded(*candidateSolution, instance, bestCandidateScore, &ordering.order()); // Note that Esswein's algorithm conserves precedence constraints compliance(at least in extended form).
+                if (!result.complete) {
                     //evaluateMeta didn't complete the eval because bound was exceeded
-                    int s_bound = e.trigger_scenario;//scenario that triggered bound
-                    int pos_s_bound = position[s_bound]; //it's position in the list
-                    if (pos_s_bound > 0) { // bubble up by one slot
-                        int s_before = scenario_order[pos_s_bound - 1]; // get the scenario before
-                        std::swap(scenario_order[pos_s_bound], scenario_order[pos_s_bound - 1]); //swap positions
-                        std::swap(position[s_bound], position[s_before]); //swap info on position
-                    }
+                    ordering.record_trigger(result.trigger_scenario); //scenario that triggered bound gets tried earlier
                     delete candidateSolution; //delete it
                     continue; //skip to next group fusion
                 }
+                int CandidateScore = result.score;
                 int CandidatelargestGroupSize = candidateSolution->largest_group_size();
                 //std::cout <<"considering :";
                 //candidateSolution->print();
@@ -589,6 +584,7 @@ public:
         // Main loop: swap while improvement exists
         bool improvement = true;
         int bestScore = policy->evaluate_meta(*currentSolution, instance); 
+        ScenarioOrdering& ordering = instance.get_scenario_ordering(); //scenarios most likely to exceed the bound first
 
         while (improvement && step<max_steps) { 
             step++;
@@ -602,7 +598,13 @@ public:
                         continue; // Skip if the candidate is invalid
                     }
 
-                    int candidate_score = policy->evaluate_meta(*candidate, instance);
+                    EvaluationResult result = policy->evaluate_meta_bounded(*candidate, instance, bestScore, &ordering.order()); //stops as soon as it can't improve
+                    if (!result.complete) {
+                        ordering.record_trigger(result.trigger_scenario);
+                        delete candidate;
+                        continue;
+                    }
+                    int candidate_score = result.score;
                     if (candidate_score < bestScore) {
                         bestScore = candidate_score;
                         if (currentSolution != initial_solution) {
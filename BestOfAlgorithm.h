@@ -61,7 +61,8 @@ public:
         for (size_t s = 0; s < instance.getS(); ++s) { //initialize for each scenario with indexes sorted by priority 
             // Sort with a lambda (descending)
             std::sort(tmp.begin(), tmp.end(), [ms, this, &currentSolution,&s, &instance](size_t a, size_t b) {
-                return policy->isLexicographicallySmaller(ms[a]->front_sequences[s], ms[b]->front_sequences[s], instance, s); 
+                SequenceHandle front_a = ms[a]->front_sequences[s], front_b = ms[b]->front_sequences[s];
+                return front_a != front_b && policy->prefers_sequence(SequencePool::global().view(front_a), SequencePool::global().view(front_b), instance, s); //same handle : same sequence
             });
             // Remplir la queue dans les deux cas
             for (size_t idx : tmp) scenarios_priority_indexes[s].push(idx);
@@ -93,6 +94,7 @@ public:
             currentSolution.remove_meta_solution_index_update(sol_index, scenarios_priority_indexes, position_of_indexes , reverse_positions );
             removes.push_back(sol_index);//saving the removed solution index to build it back when needed
             // Evaluate new score
+            if (policy->get_aggregator().get_kind() != Aggregator::Kind::MAX) currentSolution.score = policy->aggregate(currentSolution.scores); //the update only maintains the max
             int newScore = currentSolution.score; //carefull, Doesn't actually reevaluate because we updated scores by hand !
             size_t newFrontSize = currentSolution.get_front_size();
 
@@ -209,6 +211,7 @@ MetaSolution* solve(const DataInstance& instance) override {
 
         // We start with the full set of metasolutions
         ListMetaSolution<T>* currentSol = new ListMetaSolution<T>(*listMetaSolution);
+        ScenarioOrdering& ordering = instance.get_scenario_ordering(); //scenarios most likely to exceed the bound first
 
         // Continue removing until we reach k
         while (currentSol->get_meta_solutions_size() > k ) {
@@ -220,18 +223,18 @@ MetaSolution* solve(const DataInstance& instance) override {
             for (size_t i = 0; i < currentSize; ++i) {
                 // Create a temporary copy to evaluate the state after removal
                 ListMetaSolution<T> testSol = *currentSol;
-                int currentScore; //score of that solution
 
                 // Remove the i-th metasolution
                 // Note: Ensure your ListMetaSolution has a method to remove by index
                 testSol.remove_meta_solution_index(i); 
                 testSol.reset_evaluation(); // Ensure we reset evaluation to get correct score after modification (could be optimized)
                 // int currentScore = policy->evaluate_meta(testSol, instance);
-                try {
-                    currentScore = policy->evaluate_meta(testSol, instance, bestScoreFound); //eval, but get out if score is bad
-                } catch (const EvaluationBoundExceeded& e) {
+                EvaluationResult result = policy->evaluate_meta_bounded(testSol, instance, bestScoreFound, &ordering.order()); //eval, but get out if score is bad
+                if (!result.complete) {
+                    ordering.record_trigger(result.trigger_scenario);
                     continue; //skip to next candidate
                 }
+                int currentScore = result.score; //score of that solution
 
 
                 // We want to keep the subset that has the MINIMUM bottleneck score
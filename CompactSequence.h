@@ -0,0 +1,208 @@
+#ifndef COMPACT_SEQUENCE_H
+#define COMPACT_SEQUENCE_H
+
+#include "Sequence.h"
+#include "Instance.h"
+#include <vector>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <stdexcept>
+
+// Sequence of tasks stored as 16 bits task ids, inline (inside the object, no allocation) up to InlineCapacity tasks, on the heap beyond.
+// A storage format for sequences copied a lot and mostly thrown away (neighbourhoods), not a drop-in Sequence : the tasks are read by index
+// or through begin/end (there is no get_tasks reference), and to_sequence builds the Sequence the evaluations work on.
+template <int InlineCapacity>
+class BasicCompactSequence {
+public:
+    typedef uint16_t Task;
+    static constexpr int MAX_TASKS = 1 << 16; //task ids must fit in a Task
+
+    BasicCompactSequence() {}
+
+    BasicCompactSequence(const std::vector<int>& tasks) {
+        resize(tasks.size());
+        for (int i = 0; i < length; i++) set(i, tasks[i]);
+    }
+
+    BasicCompactSequence(const Sequence& sequence) : BasicCompactSequence(sequence.get_tasks()) {}
+
+    // random constructor (same sequence as Sequence(n, rng) for the same rng state)
+    BasicCompactSequence(int n, std::mt19937& rng) {
+        std::vector<int> tasks(n);
+        std::iota(tasks.begin(), tasks.end(), 0);
+        std::shuffle(tasks.begin(), tasks.end(), rng);
+        *this = BasicCompactSequence(tasks);
+    }
+
+    BasicCompactSequence(const BasicCompactSequence& other) {
+        resize(other.length);
+        std::copy(other.begin(), other.end(), data());
+    }
+
+    BasicCompactSequence(BasicCompactSequence&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    BasicCompactSequence& operator=(const BasicCompactSequence& other) {
+        if (this != &other) {
+            resize(other.length);
+            std::copy(other.begin(), other.end(), data());
+        }
+        return *this;
+    }
+
+    BasicCompactSequence& operator=(BasicCompactSequence&& other) noexcept {
+        if (this == &other) return *this;
+        if (other.heap) { //steal the heap storage
+            heap = std::move(other.heap);
+            capacity = other.capacity;
+        }
+        else {
+            heap.reset();
+            capacity = InlineCapacity;
+            std::copy(other.inline_tasks, other.inline_tasks + other.length, inline_tasks);
+        }
+        length = other.length;
+        other.length = 0;
+        other.capacity = InlineCapacity;
+        return *this;
+    }
+
+    int size() const { return length; }
+    bool empty() const { return length == 0; }
+    bool is_inline() const { return !heap; }
+
+    int operator[](int i) const { return data()[i]; }
+    void set(int i, int task) {
+        if (task < 0 || task >= MAX_TASKS) throw std::out_of_range("Task id does not fit in a CompactSequence.");
+        data()[i] = static_cast<Task>(task);
+    }
+
+    const Task* data() const { return heap ? heap.get() : inline_tasks; }
+    Task* data() { return heap ? heap.get() : inline_tasks; }
+    const Task* begin() const { return data(); }
+    const Task* end() const { return data() + length; }
+
+    //the tasks as a Sequence : a single allocation, the vector becomes the storage of the Sequence
+    Sequence to_sequence() const {
+        std::vector<int> tasks;
+        tasks.reserve(length);
+        for (int i = 0; i < length; i++) tasks.emplace_back(data()[i]);
+        return Sequence(std::move(tasks));
+    }
+
+    // Print function for displaying the sequence (same format as Sequence)
+    void print() const { std::cout << to_str(); }
+
+    std::string to_str() const {
+        std::stringstream ss;
+        for (int i = 0; i < length; i++) {
+            if (i != 0) ss << "-";
+            ss << (*this)[i];
+        }
+        return ss.str();
+    }
+
+    bool operator==(const BasicCompactSequence& other) const { return length == other.length && std::equal(begin(), end(), other.begin()); }
+    bool operator!=(const BasicCompactSequence& other) const { return !(*this == other); }
+
+    //checks precedence validity (see Sequence::check_precedence_constraints)
+    bool check_precedence_constraints(const DataInstance& instance) const {
+        const Task* tasks = data();
+        for (int i = 0; i < length - 1; ++i) {
+            for (int j = i + 1; j < length; ++j) {
+                if (instance.get_prec(tasks[j], tasks[i])) return false; // Task j must precede task i, but it doesn't
+            }
+        }
+        return true;
+    }
+
+    //moves back tasks as far as needed (see Sequence::fix_precedence_constraints)
+    BasicCompactSequence fix_precedence_constraints(const DataInstance& instance) const {
+        BasicCompactSequence fixed(*this);
+        Task* tasks = fixed.data();
+        for (int i = 0; i < length - 1; ++i) {
+            for (int j = length - 1; j > i; j--) {//going backwards to find the last first
+                if (instance.get_prec(tasks[j], tasks[i])) {
+                    std::rotate(tasks + i, tasks + i + 1, tasks + j + 1); //move task i right after task j
+                    i--;//the push incremented the counter.
+                }
+            }
+        }
+        return fixed;
+    }
+
+    BasicCompactSequence gen_swap_neighbor(int swap_index) const {
+        if (swap_index < 0 || swap_index > length - 2) throw std::runtime_error("swap index out of bounds");
+        BasicCompactSequence swaped(*this);
+        std::swap(swaped.data()[swap_index], swaped.data()[swap_index + 1]);
+        return swaped;
+    }
+
+    //calls f(neighbour) on each neighbour, in the same order as Sequence::neighbours. The neighbour is a single buffer rewritten
+    //for each call : copy it to keep it
+    template <class F>
+    void for_each_neighbour(int neighborhood_size, F&& f) const {
+        BasicCompactSequence neighbour(*this);
+        Task* tasks = neighbour.data();
+        if (neighborhood_size == 1) { // swaps
+            for (int i = 0; i < length - 1; i++) {
+                std::swap(tasks[i], tasks[i + 1]);
+                f(static_cast<const BasicCompactSequence&>(neighbour));
+                std::swap(tasks[i], tasks[i + 1]);
+            }
+        }
+        else if (neighborhood_size == 2) { // reinsertions
+            for (int i = 0; i < length; i++) {
+                for (int j = 0; j < i; j++) { // Insert before i
+                    std::rotate(tasks + j, tasks + i, tasks + i + 1);
+                    f(static_cast<const BasicCompactSequence&>(neighbour));
+                    std::rotate(tasks + j, tasks + j + 1, tasks + i + 1);
+                }
+                for (int j = i + 1; j < length; j++) { // Insert after i
+                    std::rotate(tasks + i, tasks + i + 1, tasks + j + 1);
+                    f(static_cast<const BasicCompactSequence&>(neighbour));
+                    std::rotate(tasks + i, tasks + j, tasks + j + 1);
+                }
+            }
+        }
+        else {
+            throw std::runtime_error("Neighborhood_size must be 1 or 2.");
+        }
+    }
+
+    //number of neighbours of for_each_neighbour
+    int neighbourhood_count(int neighborhood_size) const {
+        return neighborhood_size == 1 ? std::max(0, length - 1) : length * std::max(0, length - 1);
+    }
+
+    std::vector<BasicCompactSequence> neighbours(int neighborhood_size) const {
+        std::vector<BasicCompactSequence> output;
+        output.reserve(neighbourhood_count(neighborhood_size));
+        for_each_neighbour(neighborhood_size, [&](const BasicCompactSequence& neighbour) { output.push_back(neighbour); });
+        return output;
+    }
+
+private:
+    int length = 0;
+    int capacity = InlineCapacity;
+    std::unique_ptr<Task[]> heap; //null while the tasks fit inline
+    Task inline_tasks[InlineCapacity];
+
+    void resize(int n) { //contents are not kept
+        if (n > capacity) {
+            heap.reset(new Task[n]);
+            capacity = n;
+        }
+        length = n;
+    }
+};
+
+// 128 tasks inline : 256 bytes of tasks, enough for the benchmark instances (N=100, j120 with its dummy jobs)
+typedef BasicCompactSequence<128> CompactSequence;
+
+#endif // COMPACT_SEQUENCE_H
@@ -0,0 +1,91 @@
+#ifndef EVALUATION_SCRATCH_H
+#define EVALUATION_SCRATCH_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Reusable work memory for the evaluation of metasolutions (one per thread, see local()).
+// It is a bump arena : alloc(n) hands out n ints (alloc_words(n) : n 64 bits words, for bitmasks), and everything allocated inside a Frame
+// is released when the frame ends.
+// Blocks are kept between evaluations, so once the arena has grown to the size of the largest extraction, evaluating does no heap allocation.
+// Usage : { EvaluationScratch::Frame frame(scratch); int* buffer = scratch.alloc(n); ... }
+class EvaluationScratch {
+public:
+    static EvaluationScratch& local() { //scratch of the calling thread
+        thread_local EvaluationScratch scratch;
+        return scratch;
+    }
+
+    //n uninitialized ints, valid until the enclosing frame ends
+    int* alloc(size_t n) { return ints.alloc(n); }
+
+    //n ints set to value
+    int* alloc(size_t n, int value) {
+        int* p = ints.alloc(n);
+        std::fill(p, p + n, value);
+        return p;
+    }
+
+    //n 64 bits words set to 0
+    uint64_t* alloc_words(size_t n) {
+        uint64_t* p = words.alloc(n);
+        std::fill(p, p + n, 0);
+        return p;
+    }
+
+    //restores the arena position on destruction (frames can be nested)
+    class Frame {
+    public:
+        explicit Frame(EvaluationScratch& scratch)
+            : scratch(scratch), ints_block(scratch.ints.block), ints_offset(scratch.ints.offset), words_block(scratch.words.block), words_offset(scratch.words.offset) {}
+        ~Frame() {
+            scratch.ints.block = ints_block;
+            scratch.ints.offset = ints_offset;
+            scratch.words.block = words_block;
+            scratch.words.offset = words_offset;
+        }
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+    private:
+        EvaluationScratch& scratch;
+        size_t ints_block, ints_offset, words_block, words_offset;
+    };
+
+private:
+    //growing list of blocks of T, handed out in order
+    template <typename T>
+    struct Pool {
+        static constexpr size_t MIN_BLOCK = 4096;
+        std::vector<std::vector<T>> blocks;
+        size_t block = 0; //current block
+        size_t offset = 0; //first free element of the current block
+
+        T* alloc(size_t n) {
+            while (true) {
+                if (block < blocks.size()) {
+                    std::vector<T>& current = blocks[block];
+                    if (offset + n <= current.size()) {
+                        T* p = current.data() + offset;
+                        offset += n;
+                        return p;
+                    }
+                    if (block + 1 < blocks.size()) { //try the next (bigger) block
+                        block++;
+                        offset = 0;
+                        continue;
+                    }
+                }
+                blocks.emplace_back(std::max(n, blocks.empty() ? MIN_BLOCK : 2 * blocks.back().size()));
+                block = blocks.size() - 1;
+                offset = 0;
+            }
+        }
+    };
+
+    Pool<int> ints;
+    Pool<uint64_t> words;
+};
+
+#endif // EVALUATION_SCRATCH_H
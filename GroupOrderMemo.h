@@ -0,0 +1,77 @@
+#ifndef GROUP_ORDER_MEMO_H
+#define GROUP_ORDER_MEMO_H
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Ordered groups (release date order, precedences respected) per base scenario, shared by the merge steps of a GSEQ list
+// (see Policy::set_group_order_memo). Keyed and sharded like ScoreMemo. Only groups with precedences inside are stored.
+class GroupOrderMemo {
+public:
+    static constexpr int MIN_GROUP_SIZE = 8; //smaller groups are sorted faster than they are looked up
+
+    struct Key {
+        uint64_t group_hash;
+        uint64_t base_instance_id;
+        int base_scenario;
+        bool operator==(const Key& other) const {
+            return group_hash == other.group_hash && base_instance_id == other.base_instance_id && base_scenario == other.base_scenario;
+        }
+    };
+
+    //at most max_entries groups are kept (a full shard is emptied before inserting)
+    explicit GroupOrderMemo(size_t max_entries) : max_shard_entries(max_entries / NB_SHARDS + 1) {}
+
+    //copies the ordered group of key in out (g tasks). Returns false if there is none, or if it is not the group being ordered : in_group(task)
+    //must hold for its g tasks. A stored order has distinct tasks, so it then has exactly the tasks of the group (a hash collision is a miss)
+    template <typename InGroup>
+    bool find(const Key& key, int* out, int g, InGroup&& in_group) const {
+        const Shard& shard = shards[shard_of(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end() || static_cast<int>(it->second.size()) != g) return false;
+        if (!std::all_of(it->second.begin(), it->second.end(), in_group)) return false;
+        std::copy(it->second.begin(), it->second.end(), out);
+        return true;
+    }
+
+    void insert(const Key& key, const int* ordered_group, int g) {
+        Shard& shard = shards[shard_of(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.entries.size() >= max_shard_entries) shard.entries.clear();
+        shard.entries[key].assign(ordered_group, ordered_group + g);
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+        }
+    }
+
+private:
+    static constexpr size_t NB_SHARDS = 64;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t h = key.group_hash ^ (key.base_instance_id * 0x9e3779b97f4a7c15ULL) ^ (static_cast<uint64_t>(key.base_scenario) * 0xc2b2ae3d27d4eb4fULL);
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    struct Shard {
+        std::unordered_map<Key, std::vector<int>, KeyHash> entries;
+        mutable std::mutex mutex;
+    };
+
+    size_t max_shard_entries;
+    Shard shards[NB_SHARDS];
+
+    static size_t shard_of(const Key& key) { return (KeyHash{}(key) >> 7) % NB_SHARDS; }
+};
+
+#endif // GROUP_ORDER_MEMO_H
@@ -114,7 +114,8 @@ public:
         int horizon = 0;
         int max_r = 0;
         for (int d : rcpsp_instance.durations) horizon += d;
-        for (int r : rcpsp_instance.releaseDates[scenario_id]) max_r = std::max(max_r, r);
+        const int* releaseDates = rcpsp_instance.releaseDates.row(scenario_id);
+        for (int i = 0; i < rcpsp_instance.N; ++i) max_r = std::max(max_r, releaseDates[i]);
         horizon += max_r;
         
         // Contiguous memory: Resource 0 [0...H], Resource 1 [0...H], etc.
@@ -130,7 +131,7 @@ public:
 
             // 2. Initial Earliest Start Time (EST)
             // Respects sequence order (start_i >= start_{i-1}) and release date
-            int t = std::max(rcpsp_instance.releaseDates[scenario_id][task], lastTaskStart);
+            int t = std::max(releaseDates[task], lastTaskStart);
 
             // 3. Precedence: Must finish after ALL predecessors
             // We check every task previously scheduled in the sequence
@@ -246,7 +247,7 @@ public:
 
                 // instance specific parameters declaration (even if common to several instances)
                 std::vector<int> dueDate = sm_instance.dueDates;
-                std::vector<std::vector<int>> releaseDate = sm_instance.releaseDates;
+                const ScenarioMatrix& releaseDate = sm_instance.releaseDates;
                 std::vector<int> duration = sm_instance.durations;
 
                 //Declaring the interval variables
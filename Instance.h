@@ -11,9 +11,30 @@
 #include <numeric>
 #include <regex>
 #include <string>
+#include <atomic>
+#include <cstdint>
+#include "ScenarioMatrix.h"
+#include "ScenarioOrdering.h"
 
 enum class InstanceType { SINGLE_MACHINE, RCPSP };
 
+// Identifier of an object, never reused during the run (unlike its address). A copy (or an assigned object) gets a new one.
+// Evaluations are keyed by the ids of their policy and instance (see MetaSolution::evaluated_policy_id)
+class ObjectId {
+public:
+    ObjectId() : value(next()) {}
+    ObjectId(const ObjectId&) : value(next()) {}
+    ObjectId& operator=(const ObjectId&) { value = next(); return *this; }
+    uint64_t get() const { return value; }
+
+private:
+    uint64_t value;
+    static uint64_t next() {
+        static std::atomic<uint64_t> counter(0);
+        return ++counter;
+    }
+};
+
 // 1. THE INTERFACE (Pure Virtual)
 // Definitions of what an instance must provide.
 // Data common to all Sequence representing instances : S, precedence constraints, 
@@ -23,13 +44,50 @@ public:
     int N; //number of tasks
     int S; // number of scenarios in data
     std::vector<uint8_t> precedenceConstraints;
+    std::vector<int> weights; //weight of each task, for weighted objectives (see Objective.h). Not in the instance files : all 1 unless set
+    uint64_t precedence_id = new_data_id(); //identifies the scenario independent data (precedences, durations) : kept by copies and scenario splits, so data derived from it can be cached (see GroupMetaSolution::get_precedence_graph)
+    uint64_t base_instance_id = new_data_id(); //identifies the instance the scenarios come from : kept by copies and scenario splits (see get_base_scenario_id)
+    std::vector<int> base_scenario_ids; //base_scenario_ids[s] : index of scenario s in the base instance (empty : this is the base instance)
+    ObjectId object_id; //identifies this object : not kept by copies and splits (see ObjectId)
+
+    mutable ScenarioOrdering scenario_ordering; //see get_scenario_ordering
 
     virtual ~DataInstance() {}
+    static uint64_t new_data_id() {
+        static std::atomic<uint64_t> counter(0);
+        return ++counter;
+    }
     InstanceType type;
     virtual std::string get_file_name() const { return file_name; }; //file from which the data comes, helps for debug
     virtual int getS() const { return S; }; //number of scenarios
     virtual int getN() const { return N; }; //number of jobs (used as an instance size indicator mostly)
+    //index of scenario s in the base instance : scenarios of two splits of the same instance are the same if they have the same base id
+    int get_base_scenario_id(int s) const { return base_scenario_ids.empty() ? s : base_scenario_ids[s]; }
+    //order in which bounded evaluations on this instance explore its scenarios (learnt by the algorithms, see ScenarioOrdering)
+    ScenarioOrdering& get_scenario_ordering() const {
+        if (scenario_ordering.size() != S) scenario_ordering.reset(S);
+        return scenario_ordering;
+    }
+
+    //scenarios can be added (newly realized scenarios) or retired after evaluations were made : the changes are logged so that evaluations
+    //made before are updated (only new scenarios are evaluated, see MetaSolution::follow_scenario_changes) instead of recomputed
+    struct ScenarioChange {
+        int appended = 0; //number of scenarios added at the end
+        std::vector<int> retired; //indices removed (increasing)
+    };
+    std::vector<ScenarioChange> scenario_changes; //scenario_changes[r - first_logged_revision] : change from revision r to revision r+1
+    uint64_t first_logged_revision = 0; //evaluations made for an older revision can't be followed : all scenarios were replaced since
+    uint64_t get_scenario_revision() const { return first_logged_revision + scenario_changes.size(); }
+    const ScenarioChange& get_scenario_change(uint64_t r) const { return scenario_changes[r - first_logged_revision]; }
+
+    //adds scenarios at the end, given by their release dates (one vector of N values per scenario)
+    virtual void append_scenarios(const std::vector<std::vector<int>>& releaseDates) = 0;
+    //removes scenarios (indices in this instance), the others keep their order
+    virtual void retire_scenarios(std::vector<int> scenarios) = 0;
+
     virtual bool get_prec(int task1, int task2) const { return precedenceConstraints[task1 * N + task2]; } 
+    virtual const std::vector<int>& get_durations() const = 0; //processing time of each task (same in all scenarios)
+    virtual const std::vector<int>& get_due_dates() const = 0; //due date of each task (same in all scenarios)
     // Splitting function for scenarios
     virtual void extractScenarios(const DataInstance* original, const std::vector<int>& indices) = 0;
     virtual DataInstance* clone() const = 0;
@@ -151,6 +209,38 @@ virtual void print_precedences() const {
         return {train, test};
     }
 
+protected:
+    //bookkeeping of append_scenarios (once the data of the new scenarios is stored)
+    void log_appended_scenarios(int count) {
+        static std::atomic<int> next_appended_id(-1); //base ids of appended scenarios : negative, so they never match a scenario read from a file
+        if (base_scenario_ids.empty()) { base_scenario_ids.resize(S); std::iota(base_scenario_ids.begin(), base_scenario_ids.end(), 0); }
+        for (int i = 0; i < count; ++i) base_scenario_ids.push_back(next_appended_id--);
+        S += count;
+        scenario_changes.push_back({count, {}});
+        scenario_ordering.reset(S);
+    }
+
+    //bookkeeping of extractScenarios : a new revision, that no earlier one leads to (revisions stay increasing for this object)
+    void log_replaced_scenarios() {
+        first_logged_revision = get_scenario_revision() + 1;
+        scenario_changes.clear();
+    }
+
+    //bookkeeping of retire_scenarios (scenarios sorted, once their data is removed)
+    void log_retired_scenarios(const std::vector<int>& scenarios) {
+        if (base_scenario_ids.empty()) { base_scenario_ids.resize(S); std::iota(base_scenario_ids.begin(), base_scenario_ids.end(), 0); }
+        for (auto it = scenarios.rbegin(); it != scenarios.rend(); ++it) base_scenario_ids.erase(base_scenario_ids.begin() + *it);
+        S -= scenarios.size();
+        scenario_changes.push_back({0, scenarios});
+        scenario_ordering.reset(S); //positions changed
+    }
+
+    //sorts and checks the scenarios given to retire_scenarios
+    void check_retired_scenarios(std::vector<int>& scenarios) const {
+        std::sort(scenarios.begin(), scenarios.end());
+        scenarios.erase(std::unique(scenarios.begin(), scenarios.end()), scenarios.end());
+        if (!scenarios.empty() && (scenarios.front() < 0 || scenarios.back() >= S)) throw std::out_of_range("Retired scenario out of range");
+    }
 };
 
 
@@ -158,12 +248,25 @@ virtual void print_precedences() const {
 class SingleMachineInstance : public DataInstance {
 public:
     std::vector<int> durations;
-    std::vector<std::vector<int>> releaseDates;
-    std::vector<int> dueDates; //unused, but read from file for completeness (artefact from older project versions, could be useful for lateness-based objectives)
+    ScenarioMatrix releaseDates; //S x N, releaseDates[s][i] (or releaseDates.row(s)) : release date of task i in scenario s
+    std::vector<int> dueDates; //read from file, used by the tardiness objective (see Objective.h)
+
+    //task-major copy of releaseDates, built on first use for the cross-scenario kernels (see ScheduleKernels.h)
+    //release date of task i in scenario s is get_release_dates_by_task()[i * get_task_major_stride() + s]
+    const int* get_release_dates_by_task() const { return releaseDates.transposed(); }
+    int get_task_major_stride() const { return releaseDates.transposed_stride(); }
+    //tasks of scenario s sorted by (release date, id), computed once for all scenarios on first use
+    const int* get_release_order(int s) const { return releaseDates.row_order(s); }
+    //rank of each task in get_release_order(s) : comparing two tasks by (release date, id) is comparing their ranks
+    const int* get_release_rank(int s) const { return releaseDates.row_rank(s); }
+    //order class of each scenario : first scenario with the same get_release_order (see ScenarioMatrix::row_order_classes)
+    const int* get_release_order_classes() const { return releaseDates.row_order_classes(); }
 
     inline bool get_prec(int task1, int task2) const override{
         return precedenceConstraints[task1 * N + task2];
     }
+    const std::vector<int>& get_durations() const override { return durations; }
+    const std::vector<int>& get_due_dates() const override { return dueDates; }
 
 
     SingleMachineInstance() {this->type = InstanceType::SINGLE_MACHINE;}
@@ -213,13 +316,14 @@ public:
         std::getline(file, line); //eat spacing line
 
         // Read release dates
-        releaseDates.resize(S, std::vector<int>(N));
+        releaseDates.assign(S, N);
         for (int i = 0; i < S; ++i) {
             std::getline(file, line);
             ss.clear();
             ss.str(line);
+            int* row = releaseDates.row(i);
             for (int j = 0; j < N; ++j) {
-                ss >> releaseDates[i][j];
+                ss >> row[j];
             }
         }
 
@@ -233,6 +337,7 @@ public:
         for (int i = 0; i < N; ++i) {
             ss >> dueDates[i];
         }
+        weights.assign(N, 1);
         file.close();
 
     }
@@ -270,32 +375,56 @@ public:
         S = indices.size();
         N = orig->N;
         file_name = orig->file_name + "_virtual_split";
+        scenario_ordering.reset(S); //statistics are per scenario : start over
+        log_replaced_scenarios();
+        base_instance_id = orig->base_instance_id;
+        base_scenario_ids.resize(S);
+        for (int r = 0; r < S; ++r) base_scenario_ids[r] = orig->get_base_scenario_id(indices[r]);
 
         precedenceConstraints = orig->precedenceConstraints; //same for all scenarios
+        precedence_id = orig->precedence_id;
         durations = orig->durations; //same for all scenarios
         dueDates = orig->dueDates; //same for all scenarios
+        weights = orig->weights;
 
-        releaseDates.resize(S, std::vector<int>(N));
-        for (size_t i = 0; i < indices.size(); ++i) {
-            releaseDates[i] = orig->releaseDates[indices[i]];
-        }
+        releaseDates.extract_rows(orig->releaseDates, indices);
     }
  
     DataInstance* clone() const override {
         return new SingleMachineInstance(*this);
     }
 
+    void append_scenarios(const std::vector<std::vector<int>>& newReleaseDates) override {
+        for (const auto& scenario : newReleaseDates) {
+            if (static_cast<int>(scenario.size()) != N) throw std::invalid_argument("Appended scenario must give the release date of every task");
+            releaseDates.append_row(scenario);
+        }
+        log_appended_scenarios(newReleaseDates.size());
+    }
+
+    void retire_scenarios(std::vector<int> scenarios) override {
+        check_retired_scenarios(scenarios);
+        releaseDates.remove_rows(scenarios);
+        log_retired_scenarios(scenarios);
+    }
 };
 
 
 class RCPSPInstance : public DataInstance {
 public:
     std::vector<int> durations;
-    std::vector<std::vector<int>> releaseDates;
-    std::vector<int> dueDates; //unused, but read from file for completeness (artefact from older project versions, could be useful for lateness-based objectives)
+    ScenarioMatrix releaseDates; //S x N, same layout as SingleMachineInstance
+    std::vector<int> dueDates; //not in RCPSP files (all 0), used by the tardiness objective (see Objective.h)
     int num_resources;
     std::vector<int> capacities;
-    std::vector<std::vector<int>> usages; 
+    ScenarioMatrix usages; //N x num_resources, usages[i][r] : usage of resource r by task i
+
+    //tasks of scenario s sorted by (release date, id), computed once for all scenarios on first use
+    const int* get_release_order(int s) const { return releaseDates.row_order(s); }
+    //rank of each task in get_release_order(s) : comparing two tasks by (release date, id) is comparing their ranks
+    const int* get_release_rank(int s) const { return releaseDates.row_rank(s); }
+    //order class of each scenario : first scenario with the same get_release_order (see ScenarioMatrix::row_order_classes)
+    const int* get_release_order_classes() const { return releaseDates.row_order_classes(); }
 
 
     RCPSPInstance(const std::string& filename) {
@@ -317,9 +446,8 @@ public:
                 }
                 precedenceConstraints.assign(N * N, 0);
                 durations.resize(N);
-                usages.resize(N);
                 // Initialize default release dates (1 scenario of zeros)
-                releaseDates.assign(1, std::vector<int>(N, 0));
+                releaseDates.assign(1, N, 0);
             }
             // 2. Robust Resource Count Parsing
             else if (line.find("- renewable") != std::string::npos) {
@@ -328,6 +456,7 @@ public:
                 while (ss >> temp && temp != ":"); 
                 ss >> num_resources;
                 capacities.resize(num_resources);
+                usages.assign(N, num_resources, 0);
             }
             // 3. Precedence Relations
             else if (line.find("PRECEDENCE RELATIONS:") != std::string::npos) {
@@ -353,7 +482,6 @@ public:
                     std::stringstream ss(line);
                     int jobIdx, mode;
                     ss >> jobIdx >> mode >> durations[i];
-                    usages[i].resize(num_resources);
                     for (int r = 0; r < num_resources; ++r) {
                         ss >> usages[i][r];
                     }
@@ -374,12 +502,13 @@ public:
                     if (line.find("scenarios") != std::string::npos) {
                         size_t pos = line.find(':');
                         this->S = std::stoi(line.substr(pos + 1));
-                        releaseDates.assign(S, std::vector<int>(N, 0));
+                        releaseDates.assign(S, N, 0);
                     }
                     else if (line.find("RELEASE DATES SCENARIOS:") != std::string::npos) {
                         for (int s = 0; s < S; ++s) {
+                            int* row = releaseDates.row(s);
                             for (int j = 0; j < N; ++j) {
-                                if (!(file >> releaseDates[s][j])) break;
+                                if (!(file >> row[j])) break;
                             }
                         }
                         break; 
@@ -389,6 +518,7 @@ public:
         }
         
         dueDates.assign(N, 0); //no due dates in RCPSP instances, but keep just in case
+        weights.assign(N, 1);
         file.close();
     }
 
@@ -428,16 +558,20 @@ public:
         S = indices.size();
         N = orig->N;
         file_name = orig->file_name + "_virtual_split";
+        scenario_ordering.reset(S); //statistics are per scenario : start over
+        log_replaced_scenarios();
+        base_instance_id = orig->base_instance_id;
+        base_scenario_ids.resize(S);
+        for (int r = 0; r < S; ++r) base_scenario_ids[r] = orig->get_base_scenario_id(indices[r]);
         num_resources = orig->num_resources;
         precedenceConstraints = orig->precedenceConstraints; //same for all scenarios
+        precedence_id = orig->precedence_id;
         durations = orig->durations; //same for all scenarios
         dueDates = orig->dueDates; //same for all scenarios
+        weights = orig->weights;
         capacities = orig->capacities;
         usages = orig->usages;
-        releaseDates.resize(S, std::vector<int>(N));
-        for (size_t i = 0; i < indices.size(); ++i) {
-            releaseDates[i] = orig->releaseDates[indices[i]];
-        }
+        releaseDates.extract_rows(orig->releaseDates, indices);
     }
  
 
@@ -445,6 +579,23 @@ public:
         return new RCPSPInstance(*this);
     }
 
+    void append_scenarios(const std::vector<std::vector<int>>& newReleaseDates) override {
+        for (const auto& scenario : newReleaseDates) {
+            if (static_cast<int>(scenario.size()) != N) throw std::invalid_argument("Appended scenario must give the release date of every task");
+            releaseDates.append_row(scenario);
+        }
+        log_appended_scenarios(newReleaseDates.size());
+    }
+
+    void retire_scenarios(std::vector<int> scenarios) override {
+        check_retired_scenarios(scenarios);
+        releaseDates.remove_rows(scenarios);
+        log_retired_scenarios(scenarios);
+    }
+
+    const std::vector<int>& get_durations() const override { return durations; }
+    const std::vector<int>& get_due_dates() const override { return dueDates; }
+
     void print_summary() const override {
         DataInstance::print_summary();
         std::cout << "Resources: " << num_resources << std::endl;
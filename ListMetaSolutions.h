@@ -17,15 +17,9 @@ public:
     virtual void remove_meta_solution_index(size_t index)  = 0;
     virtual void remove_meta_solution_index_update(size_t index, std::vector<std::queue<size_t>>& scenarios_priority_indexes, std::vector<int>& scenarios_position_of_indexes,  std::vector<size_t>& scenarios_reverse_positions)  = 0;
 
-    //call when modifying solution in place, removes evaluated tag to re trigger evaluation.
-    void reset_evaluation() override { // has more things to do than default metasolution re-evaluation
-        scored_by = nullptr;
-        scored_for = nullptr;
-        score = -1;
-        scores.clear();
-        front_sequences.clear();
-        front_indexes.clear(); //also needs to clear this information
-    }
+    //call reset_evaluation when modifying solution in place, removes evaluated tag to re trigger evaluation.
+    //front indexes are part of the evaluation : cleared/saved with it
+    std::vector<int>* evaluation_indexes() override { return &front_indexes; }
 
     std::vector<int> front_indexes; //index of the metasolution (in the list) used for each scenario
 
@@ -113,7 +107,7 @@ public:
                 //update sequences[s], scores[s], front indexs[s] accordingly    
                 this->front_indexes[s] = position; //front indexes keeps track of CURRENT indexes so the solution in itself must always be coherent. the information of og indexes is used only in the BO data (the three arrays input)
                 this->scores[s] = metaSolutions[position].scores[s];
-                this->front_sequences[s] = metaSolutions[position].front_sequences[s];
+                if (!this->fronts_omitted) this->front_sequences.set(s, metaSolutions[position].front_sequences[s]); //handles : no sequence copy
             }
             if (this->front_indexes[s] == metaSolutions.size()-1){//else if we were using the last one (or if the next most prio is the last one), then obsolete pointer to element to be deleted (case 1 : next in queue was that eleement, so we said the front index was last, but it'll move. )
                 this->front_indexes[s] = index; //then it has been moved to index position
@@ -129,8 +123,10 @@ public:
         reverse_positions[index] = moved_id; //keeping track of change in id (actual change to the submetasol list made before loop) reflected in reverse list
         reverse_positions.pop_back(); //delete entry (mirrors actual list)
 
-        this->score = maxScore; //updating global score of solution
+        this->score = maxScore; //updating global score of solution (max aggregator, see BestOfAlgorithm for the others)
         metaSolutions.pop_back();
+        saved_evaluations.clear(); //only the current evaluation is updated
+        scores_changed();
 
         // all changes made by hand, no reset_evaluation();
     }
@@ -158,6 +154,18 @@ public:
         return metaSolutionPtrs;
     }
 
+    Fingerprint fingerprint() const override { //sub metasolutions in order (front indexes refer to it)
+        Fingerprint f;
+        f.mix(3); //type tag
+        for (const T& solution : metaSolutions) {
+            Fingerprint sub = solution.fingerprint();
+            if (!sub.memoized()) return Fingerprint();
+            f.mix(sub.hash);
+            f.mix(sub.check);
+        }
+        return f;
+    }
+
     // returns the number of meta-solutions in the front (based on used indexes) Note that this number has no guarantee to be the smallest front possible
     size_t get_front_size()   {
         if (!scored_by){//metasol was not already scored -> error
@@ -176,11 +184,7 @@ public:
     // returns the simplified metasolution that contains only the expressed submetasolutions
     // takes an instance as input, outputs the front for that instance.  (same training score if it's the training instance eg)
     ListMetaSolution<T>* front_sub_metasolutions(Policy * policy, const DataInstance &instance)   {
-        if (!scored_by){//metasol was not already scored -> score it before continuing
-            policy->evaluate_meta(*this, instance);
-        }
-        else if (scored_by!=policy || scored_for!=&instance){ // else if it is scored but not by this policy, or not for this instance
-            reset_evaluation(); //reset it and then score
+        if (!scored_by || !evaluation_of(policy->object_id.get(), instance.object_id.get())){ //metasol was not already scored for this policy and instance -> score it before continuing (evaluations for other instances are kept aside)
             policy->evaluate_meta(*this, instance);
         }
 
@@ -2,11 +2,20 @@
 #define METASOLUTIONS_H
 
 #include "Sequence.h"
+#include "CompactSequence.h"
+#include "SequencePool.h"
+#include "ScoreMemo.h"
 #include "Policy.h"
+#include "Aggregator.h"
 #include <vector>
 #include <iostream>
 #include <unordered_map>
 #include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <numeric>
+#include <limits>
+#include <cstdint>
 
 class Policy; //had a circular compile issue that this fixed. Could probably be removed.
 
@@ -17,49 +26,185 @@ public:
     virtual void print() const = 0;
 
     //following attributes save scores and sequences for efficiency purposes. Note that ultimately, they depend on a policy, which is ssumed to be unique here.
-    std::vector<Sequence> front_sequences; // front of the metasolution : the sequence expressed for each scenario
+    //Not thread safe : a metasolution is evaluated by one call at a time (the threads of a policy share the scenarios of that call)
+    FrontSequences front_sequences; // front of the metasolution : the sequence expressed for each scenario (pooled, see SequencePool)
+    bool fronts_omitted = false; //the evaluation recorded the scores only (see Policy::evaluate_scores) : front_sequences is empty
     std::vector<int> scores; //scores of the expressed sequence in each scenario.
     int score = -1; //the aggregated score
     //is set and marked by policy when evaluated for the first time
     Policy * scored_by = nullptr;
     const DataInstance * scored_for = nullptr;
+    //set instead when a bounded evaluation stopped early (see Policy::evaluate_meta_bounded) : scores/front_sequences are only valid
+    //for the scenarios already evaluated, the others have score NOT_EVALUATED. A later evaluation by the same policy resumes from there.
+    static constexpr int NOT_EVALUATED = std::numeric_limits<int>::min();
+    Policy * partially_scored_by = nullptr;
+    const DataInstance * partially_scored_for = nullptr;
+    //ObjectIds of the policy and instance of the current (complete or partial) evaluation, 0 if none : the pointers alone would match
+    //a new object created at the address of a destroyed one
+    uint64_t evaluated_policy_id = 0;
+    uint64_t evaluated_instance_id = 0;
+    uint64_t evaluated_revision = 0; //scenario revision of the instance (DataInstance::get_scenario_revision) the evaluation was made for
+
+    //evaluations for other (policy, instance) pairs, kept when the metasolution is evaluated for a new pair (see Policy::evaluate_meta)
+    //so that alternating between instances (train/test) does not recompute everything. Least recently used first.
+    struct SavedEvaluation {
+        Policy * policy;
+        const DataInstance * instance;
+        uint64_t policy_id; //the evaluation is found by these ids (see evaluated_policy_id)
+        uint64_t instance_id;
+        int score;
+        uint64_t revision;
+        std::vector<int> scores;
+        FrontSequences front_sequences;
+        bool fronts_omitted;
+        std::vector<int> front_indexes; //lists only
+    };
+    static constexpr size_t MAX_SAVED_EVALUATIONS = 3;
+    std::vector<SavedEvaluation> saved_evaluations;
+
+    virtual void reset_evaluation() { // resets the evaluation to call again (call when modifying the metasolution : saved evaluations are dropped too)
+        clear_evaluation();
+        saved_evaluations.clear();
+    }
 
-    virtual void reset_evaluation() { // resets the evaluation to call again (with other policy, or other instance.)
+    virtual void clear_evaluation() { // forgets the current evaluation only
         scored_by = nullptr;
         scored_for = nullptr;
+        partially_scored_by = nullptr;
+        partially_scored_for = nullptr;
+        evaluated_policy_id = 0;
+        evaluated_instance_id = 0;
         score = -1;
         scores.clear();
         front_sequences.clear();
+        fronts_omitted = false;
+        if (std::vector<int>* indexes = evaluation_indexes()) indexes->clear();
+        scores_changed();
+    }
+
+    //true if the current (complete or partial) evaluation was made by the policy and for the instance with these ObjectIds
+    bool evaluation_of(uint64_t policy_id, uint64_t instance_id) const {
+        return evaluated_policy_id == policy_id && evaluated_instance_id == instance_id;
+    }
+
+    //to call whenever scores are modified : drops the statistics computed from them (see get_sorted_scores)
+    void scores_changed() { sorted_scores_valid = false; }
+
+    //moves the current evaluation (if complete) to saved_evaluations. The metasolution is then not scored
+    void stash_evaluation() {
+        if (scored_by) {
+            if (saved_evaluations.size() >= MAX_SAVED_EVALUATIONS) saved_evaluations.erase(saved_evaluations.begin()); //drop the least recently used
+            std::vector<int>* indexes = evaluation_indexes();
+            saved_evaluations.push_back({scored_by, scored_for, evaluated_policy_id, evaluated_instance_id, score, evaluated_revision, std::move(scores), std::move(front_sequences),
+                                         fronts_omitted, indexes ? std::move(*indexes) : std::vector<int>()});
+        }
+        clear_evaluation();
+    }
+
+    //makes the saved evaluation by the policy for the instance with these ObjectIds the current one. Returns false if there is none
+    bool restore_evaluation(uint64_t policy_id, uint64_t instance_id) {
+        for (size_t i = 0; i < saved_evaluations.size(); ++i) {
+            SavedEvaluation& saved = saved_evaluations[i];
+            if (saved.policy_id == policy_id && saved.instance_id == instance_id) {
+                clear_evaluation();
+                scored_by = saved.policy;
+                scored_for = saved.instance;
+                evaluated_policy_id = saved.policy_id;
+                evaluated_instance_id = saved.instance_id;
+                score = saved.score;
+                evaluated_revision = saved.revision;
+                scores = std::move(saved.scores);
+                front_sequences = std::move(saved.front_sequences);
+                fronts_omitted = saved.fronts_omitted;
+                if (std::vector<int>* indexes = evaluation_indexes()) *indexes = std::move(saved.front_indexes);
+                saved_evaluations.erase(saved_evaluations.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //brings the current (complete or partial) evaluation, made for an older scenario revision of its instance, to the current scenarios
+    //(see DataInstance::append_scenarios/retire_scenarios) : retired scenarios are dropped, appended ones are NOT_EVALUATED.
+    //A complete evaluation becomes partial : the next evaluate_meta resumes it, evaluating only the appended scenarios, then aggregates again.
+    //With max_aggregate (score is the max of the scores) and only retirements, it stays complete : the max is rescanned only if a retired
+    //scenario held it. The evaluation is dropped if the scenarios were replaced since (see DataInstance::first_logged_revision)
+    void follow_scenario_changes(const DataInstance& instance, bool max_aggregate = false) {
+        if (evaluated_revision < instance.first_logged_revision) {
+            clear_evaluation();
+            return;
+        }
+        std::vector<int>* indexes = evaluation_indexes();
+        bool appended = false;
+        bool max_retired = false;
+        for (uint64_t r = evaluated_revision; r < instance.get_scenario_revision(); ++r) {
+            const DataInstance::ScenarioChange& change = instance.get_scenario_change(r);
+            if (change.appended > 0) {
+                appended = true;
+                scores.resize(scores.size() + change.appended, NOT_EVALUATED);
+                if (!fronts_omitted) front_sequences.resize(scores.size());
+                if (indexes) indexes->resize(scores.size(), 0);
+            }
+            for (auto it = change.retired.rbegin(); it != change.retired.rend(); ++it) {
+                max_retired = max_retired || scores[*it] >= score;
+                scores.erase(scores.begin() + *it);
+                if (!fronts_omitted) front_sequences.erase(*it);
+                if (indexes) indexes->erase(indexes->begin() + *it);
+            }
+        }
+        evaluated_revision = instance.get_scenario_revision();
+        scores_changed();
+        if (scored_by && max_aggregate && !appended && !scores.empty()) {
+            if (max_retired) score = *std::max_element(scores.begin(), scores.end());
+            return;
+        }
+        if (scored_by) { //the aggregate (any aggregator, see Policy::set_aggregator) is recomputed by the policy
+            partially_scored_by = scored_by;
+            partially_scored_for = scored_for;
+            scored_by = nullptr;
+            scored_for = nullptr;
+        }
     }
 
+    //per scenario data of the evaluation besides scores and front sequences, saved with them (front indexes of lists)
+    virtual std::vector<int>* evaluation_indexes() { return nullptr; }
+
+    //identifies the content of the metasolution (same content, same fingerprint) for the score memo (see ScoreMemo). Zero : not memoized
+    virtual Fingerprint fingerprint() const { return Fingerprint(); }
+
+    //combines a value in a 64 bits hash (see Fingerprint)
+    static uint64_t fingerprint_mix(uint64_t h, uint64_t value) { return Fingerprint::mix_hash(h, value); }
+
     //quantile function to get a specific quantile score among scenarios.
     // WARNING : doesn't check who did the evaluation
     int get_quantile(double quantile, Policy &policy , DataInstance &instance) const {
-        if (!scored_by) throw std::runtime_error("metasolution must be scored");
-        if (scored_by != &policy) throw std::runtime_error("metasolution was scored for another policy");
-        if (scored_for != &instance) throw std::runtime_error("metasolution was scored for another instance");
         if (quantile < 0 || quantile > 1) throw std::invalid_argument("Quantile must be between 0 and 1.");
+        const std::vector<int>& sorted_scores = get_sorted_scores(policy, instance);
+        if (sorted_scores.empty()) throw std::runtime_error("metasolution has no scenario scores");
+        return sorted_scores[Aggregator::quantile_index(quantile, sorted_scores.size())];
+    }
 
-        //sort the scores
-        std::vector<int> sorted_scores = scores;
-        std::sort(sorted_scores.begin(), sorted_scores.end());
-
-        size_t index = static_cast<size_t>(std::ceil(quantile * sorted_scores.size())) - 1;
-        if (index >= sorted_scores.size()) index = sorted_scores.size() - 1; // clamp
-
-    return sorted_scores[index];
+    //any statistic of the scores (quantile, CVaR, mean, max : see Aggregator), from the cached sorted scores
+    int get_aggregate(const Aggregator& aggregator, Policy &policy, DataInstance &instance) const {
+        return aggregator.aggregate_sorted(get_sorted_scores(policy, instance));
     }
 
     //basicly a proxy for scores, sorted
     std::vector<int> get_quantiles(Policy &policy, DataInstance &instance) const {
+        return get_sorted_scores(policy, instance);
+    }
+
+    //scores sorted in increasing order, sorted once per evaluation and kept until the scores change (not thread safe)
+    const std::vector<int>& get_sorted_scores(Policy &policy, DataInstance &instance) const {
         if (!scored_by) throw std::runtime_error("metasolution must be scored");
         if (scored_by != &policy) throw std::runtime_error("metasolution was scored for another policy");
         if (scored_for != &instance) throw std::runtime_error("metasolution was scored for another instance");
-        //sort the scores
-        std::vector<int> sorted_scores = scores;
-        std::sort(sorted_scores.begin(), sorted_scores.end());
-
-    return sorted_scores;
+        if (!sorted_scores_valid) {
+            sorted_scores = scores;
+            std::sort(sorted_scores.begin(), sorted_scores.end());
+            sorted_scores_valid = true;
+        }
+        return sorted_scores;
     }
 
     //literally a proxy for scores, unsorted (in order of scenarios used (see used scenario_list))
@@ -72,8 +217,133 @@ public:
 
     return output_scores;
     }
+
+private:
+    mutable std::vector<int> sorted_scores; //see get_sorted_scores
+    mutable bool sorted_scores_valid = false;
+};
+
+
+// Precedence subgraph of each group of a GroupMetaSolution (does not depend on the scenario).
+// Nodes of group k are numbered by their position in the group : node i of group k has global id node_begin[k] + i.
+// pred_count[id] : number of predecessors inside the group. Successors of id (positions in the group) : succ[succ_begin[id] .. succ_begin[id+1])
+// Also keeps the other scenario independent orderings of the groups : duration_order[node_begin[k] + p] is the position in group k of its p-th task
+// by (duration, id), and duration_position is its inverse.
+// spt_completion_bound[m] : smallest possible sum of completion times of m tasks of the instance started at time 0 (its m shortest tasks in SPT order),
+// used to bound the remaining work of a partial schedule.
+// group_hash[k] : hash of the content of group k, independent of the order of its tasks (identifies the group across metasolutions, see GroupOrderMemo).
+struct GroupPrecedenceGraph {
+    std::vector<int> node_begin;
+    std::vector<int> pred_count;
+    std::vector<int> succ_begin;
+    std::vector<int> succ;
+    std::vector<int> group_of; //group_of[task] : index of the group containing task (-1 if none)
+    std::vector<int> position_of; //position_of[task] : position of task in its group
+    std::vector<int> duration_order;
+    std::vector<int> duration_position;
+    std::vector<long long> spt_completion_bound;
+    std::vector<uint64_t> group_hash;
+    bool has_free_group = false;
+
+    void build(const std::vector<std::vector<int>>& taskGroups, const DataInstance& instance) {
+        const int N = instance.getN();
+        const uint8_t* prec = instance.precedenceConstraints.data();
+        node_begin.assign(1, 0);
+        pred_count.clear();
+        succ_begin.assign(1, 0);
+        succ.clear();
+        has_free_group = false;
+        group_of.assign(N, -1);
+        position_of.assign(N, -1);
+        duration_order.clear();
+        duration_position.clear();
+        group_hash.assign(taskGroups.size(), 0);
+        const std::vector<int>& durations = instance.get_durations();
+        std::vector<int> shortest(durations);
+        std::sort(shortest.begin(), shortest.end());
+        spt_completion_bound.assign(N + 1, 0);
+        long long end = 0; //completion time of the m-th shortest task
+        for (int m = 1; m <= N; m++) {
+            end += shortest[m - 1];
+            spt_completion_bound[m] = spt_completion_bound[m - 1] + end;
+        }
+        for (size_t k = 0; k < taskGroups.size(); k++) {
+            const auto& group = taskGroups[k];
+            const int g = group.size();
+            const int base = pred_count.size();
+            for (int i = 0; i < g; i++) {
+                group_of[group[i]] = k;
+                position_of[group[i]] = i;
+                group_hash[k] += MetaSolution::fingerprint_mix(0, group[i]); //sum : same hash in any order
+            }
+            duration_order.resize(base + g);
+            duration_position.resize(base + g);
+            std::iota(duration_order.begin() + base, duration_order.end(), 0);
+            std::sort(duration_order.begin() + base, duration_order.end(), [&](int i1, int i2) {
+                int t1 = group[i1];
+                int t2 = group[i2];
+                return durations[t1] < durations[t2] || (durations[t1] == durations[t2] && t1 < t2);
+            });
+            for (int p = 0; p < g; p++) duration_position[base + duration_order[base + p]] = p;
+            pred_count.resize(base + g, 0);
+            for (int i = 0; i < g; i++) {
+                const uint8_t* successors = prec + static_cast<size_t>(group[i]) * N;
+                for (int j = 0; j < g; j++) {
+                    if (successors[group[j]]) { //task i of the group must be before task j
+                        succ.push_back(j);
+                        pred_count[base + j]++;
+                    }
+                }
+                succ_begin.push_back(succ.size());
+            }
+            node_begin.push_back(base + g);
+            has_free_group = has_free_group || is_free(k);
+        }
+    }
+
+    //true if group k has no precedence inside it (any order of its tasks is valid)
+    bool is_free(int k) const { return succ_begin[node_begin[k]] == succ_begin[node_begin[k + 1]]; }
 };
 
+// Lazily built GroupPrecedenceGraph, for the precedences of one instance (DataInstance::precedence_id).
+// get() is thread safe (scenarios of a metasolution can be extracted concurrently). The graph is copied with the metasolution.
+class GroupPrecedenceCache {
+public:
+    GroupPrecedenceCache() {}
+    GroupPrecedenceCache(const GroupPrecedenceCache& other) { copy_from(other); }
+    GroupPrecedenceCache& operator=(const GroupPrecedenceCache& other) {
+        if (this != &other) copy_from(other);
+        return *this;
+    }
+
+    const GroupPrecedenceGraph& get(const std::vector<std::vector<int>>& taskGroups, const DataInstance& instance) const {
+        if (built_for.load(std::memory_order_acquire) != instance.precedence_id) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (built_for.load(std::memory_order_relaxed) != instance.precedence_id) {
+                graph.build(taskGroups, instance);
+                built_for.store(instance.precedence_id, std::memory_order_release);
+            }
+        }
+        return graph;
+    }
+
+    void invalidate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        built_for.store(0);
+    }
+
+private:
+    mutable GroupPrecedenceGraph graph;
+    mutable std::atomic<uint64_t> built_for{0}; //precedence_id of the instance the graph was built for (0 : none)
+    mutable std::mutex mutex;
+
+    void copy_from(const GroupPrecedenceCache& other) {
+        std::lock_guard<std::mutex> lock(other.mutex);
+        std::lock_guard<std::mutex> own_lock(mutex);
+        graph = other.graph;
+        built_for.store(other.built_for.load());
+    }
+};
 
 // GroupMetaSolution: A specific meta solution that stores a sequence of permutable groups
 class GroupMetaSolution : public MetaSolution {
@@ -154,9 +424,16 @@ public:
     }
 
     std::vector<std::vector<int>>& get_task_groups_modifiable(){
+        precedenceCache.invalidate(); //groups may change
+        saved_evaluations.clear();
         return taskGroups;
     }
 
+    //precedence subgraph of each group for the instance precedences (built on first use, then cached)
+    const GroupPrecedenceGraph& get_precedence_graph(const DataInstance& instance) const {
+        return precedenceCache.get(taskGroups, instance);
+    }
+
     bool operator==(const MetaSolution& other) const {
         // We downcast to the derived class here
         const GroupMetaSolution* groupMeta = dynamic_cast<const GroupMetaSolution*>(&other);
@@ -196,9 +473,23 @@ public:
 
         return true; // All groups match
     }
+
+    Fingerprint fingerprint() const override { //order inside a group does not matter
+        Fingerprint f;
+        f.mix(2); //type tag
+        std::vector<int> sortedGroup;
+        for (const auto& group : taskGroups) {
+            sortedGroup = group;
+            std::sort(sortedGroup.begin(), sortedGroup.end());
+            for (int task : sortedGroup) f.mix(task);
+            f.mix(~uint64_t(0)); //end of group
+        }
+        return f;
+    }
     
 private:
     std::vector<std::vector<int>> taskGroups; // A sequence of sets of tasks
+    GroupPrecedenceCache precedenceCache;
 };
 
 //introducing hashes for groupMetaSolutions
@@ -224,6 +515,9 @@ public:
     SequenceMetaSolution(const Sequence& taskSequence)
         : taskSequence(taskSequence) {}
 
+    SequenceMetaSolution(Sequence&& taskSequence)
+        : taskSequence(std::move(taskSequence)) {}
+
     SequenceMetaSolution(const std::vector<int>& taskSequence) //alternative definition of a sequence using raw vector (not recommended)
         : taskSequence(Sequence(taskSequence)) {}
 
@@ -238,10 +532,9 @@ public:
         return new GroupMetaSolution(vectorgroup);
     }
     SequenceMetaSolution* gen_swap_neighbor(int swap_index, const DataInstance& instance){
-        Sequence seq =  this->get_sequence();
-        Sequence swaped =  seq.gen_swap_neighbor(swap_index);
+        CompactSequence swaped = CompactSequence(this->get_sequence()).gen_swap_neighbor(swap_index); //no allocation until it is known to be valid
         if (swaped.check_precedence_constraints(instance)){
-            return new SequenceMetaSolution(swaped);
+            return new SequenceMetaSolution(swaped.to_sequence());
         }
         else{
             throw InvalidSolutionException();
@@ -250,14 +543,12 @@ public:
 
     std::vector<SequenceMetaSolution> gen_neighbors(int neighborhood_size, const DataInstance& instance){//generates list of nighboring JSEQ solutions (defers to sequence neighborhood)
         std::vector<SequenceMetaSolution> output;
-        std::vector<Sequence> neighboring_sequences = taskSequence.neighbours(neighborhood_size);
-        for (size_t i = 0; i < neighboring_sequences.size(); i++)
-        {
+        CompactSequence compact(taskSequence);
+        output.reserve(compact.neighbourhood_count(neighborhood_size));
+        compact.for_each_neighbour(neighborhood_size, [&](const CompactSequence& neighbour) { //one buffer for the whole neighbourhood
             //if an instance is provided, remove invalid precedence-wise sequences
-            if (neighboring_sequences[i].check_precedence_constraints(instance)){
-                output.push_back(SequenceMetaSolution(neighboring_sequences[i]));
-            }
-        }
+            if (neighbour.check_precedence_constraints(instance)) output.emplace_back(neighbour.to_sequence());
+        });
         return output;
     }
     void print() const override{
@@ -282,6 +573,13 @@ public:
     bool compareSeqs(const SequenceMetaSolution& other) const  {
         return taskSequence.get_tasks() == other.taskSequence.get_tasks();
     }
+
+    Fingerprint fingerprint() const override {
+        Fingerprint f;
+        f.mix(1); //type tag
+        for (int task : taskSequence.get_tasks()) f.mix(task);
+        return f;
+    }
     
 private:
     Sequence taskSequence;
@@ -0,0 +1,97 @@
+#ifndef OBJECTIVE_H
+#define OBJECTIVE_H
+
+#include "Instance.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+// Objectives of a schedule in one scenario (see Policy::set_objective). Each objective is a small struct used as a template parameter
+// by the evaluation loops, so every (policy, objective) pair compiles to its own loop without any per task or per scenario branch :
+//   add(value, task, completion, data) : objective value once task completes at completion (tasks are added in sequence order, value starts at 0)
+//   lower_bound(value, time, m, spt_completion_bound) : lower bound of the final value when m tasks are left after time (all durations >= 0),
+//       spt_completion_bound as in GroupPrecedenceGraph. Used by bounded evaluations to give up early
+// with_objective(kind, f) calls f(Objective{}) for the objective of kind : the runtime choice is made once per block of scenarios.
+enum class ObjectiveKind { SUM_COMPLETION, MAKESPAN, WEIGHTED_COMPLETION, TOTAL_TARDINESS };
+
+// scenario independent task data used by the objectives
+struct ObjectiveData {
+    const int* durations;
+    const int* due_dates;
+    const int* weights;
+
+    static ObjectiveData of(const DataInstance& instance) {
+        return {instance.get_durations().data(), instance.get_due_dates().data(), instance.weights.data()};
+    }
+};
+
+//sum of completion times (the default)
+struct SumCompletion {
+    static constexpr ObjectiveKind kind = ObjectiveKind::SUM_COMPLETION;
+    static int add(int value, int, int completion, const ObjectiveData&) { return value + completion; }
+    static long long lower_bound(long long value, int time, int m, const long long* spt_completion_bound) {
+        return value + static_cast<long long>(m) * time + spt_completion_bound[m]; //the m tasks left complete no sooner than the m shortest ones
+    }
+};
+
+//completion time of the last task
+struct Makespan {
+    static constexpr ObjectiveKind kind = ObjectiveKind::MAKESPAN;
+    static int add(int value, int, int completion, const ObjectiveData&) { return std::max(value, completion); }
+    static long long lower_bound(long long value, int time, int m, const long long* spt_completion_bound) {
+        if (m == 0) return value;
+        return std::max<long long>(value, time + spt_completion_bound[m] - spt_completion_bound[m - 1]); //the m shortest durations, back to back
+    }
+};
+
+//sum of weight * completion time (DataInstance::weights)
+struct WeightedCompletion {
+    static constexpr ObjectiveKind kind = ObjectiveKind::WEIGHTED_COMPLETION;
+    static int add(int value, int task, int completion, const ObjectiveData& data) { return value + data.weights[task] * completion; }
+    static long long lower_bound(long long value, int, int, const long long*) { return value; }
+};
+
+//sum of the lateness of late tasks, max(0, completion - due date)
+struct TotalTardiness {
+    static constexpr ObjectiveKind kind = ObjectiveKind::TOTAL_TARDINESS;
+    static int add(int value, int task, int completion, const ObjectiveData& data) { return value + std::max(0, completion - data.due_dates[task]); }
+    static long long lower_bound(long long value, int, int, const long long*) { return value; }
+};
+
+//no objective : for the extractions that only need the sequence (the fused extract and score loops then skip the scoring)
+struct NoObjective {
+    static int add(int, int, int, const ObjectiveData&) { return 0; }
+    static long long lower_bound(long long, int, int, const long long*) { return 0; }
+};
+
+template <typename F>
+decltype(auto) with_objective(ObjectiveKind kind, F&& f) {
+    switch (kind) {
+        case ObjectiveKind::SUM_COMPLETION: return f(SumCompletion{});
+        case ObjectiveKind::MAKESPAN: return f(Makespan{});
+        case ObjectiveKind::WEIGHTED_COMPLETION: return f(WeightedCompletion{});
+        case ObjectiveKind::TOTAL_TARDINESS: return f(TotalTardiness{});
+    }
+    throw std::invalid_argument("Unknown objective.");
+}
+
+inline std::string objective_name(ObjectiveKind kind) {
+    switch (kind) {
+        case ObjectiveKind::SUM_COMPLETION: return "sumci";
+        case ObjectiveKind::MAKESPAN: return "makespan";
+        case ObjectiveKind::WEIGHTED_COMPLETION: return "weighted_sumci";
+        case ObjectiveKind::TOTAL_TARDINESS: return "total_tardiness";
+    }
+    return "unknown";
+}
+
+//objective of a schedule given by the start time of each task
+template <typename Objective>
+int objective_of_start_times(const int* startTimes, int N, const ObjectiveData& data) {
+    int value = 0;
+    for (int i = 0; i < N; ++i) value = Objective::add(value, i, startTimes[i] + data.durations[i], data);
+    return value;
+}
+
+#endif // OBJECTIVE_H
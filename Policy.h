@@ -7,8 +7,24 @@
 #include "Sequence.h"
 #include "Schedule.h"
 #include "Instance.h"
+#include "WorkerPool.h"
+#include "ScheduleKernels.h"
+#include "EvaluationScratch.h"
+#include "ScoreMemo.h"
+#include "GroupOrderMemo.h"
+#include "Aggregator.h"
+#include "Objective.h"
+#include "ScoreMatrix.h"
+#include "SequencePool.h"
 #include <vector>
 #include <optional>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
 #include <ilcp/cp.h>
 
 #include <tuple>
@@ -25,6 +41,23 @@ public:
     }
 };
 
+//outcome of Policy::evaluate_meta_bounded
+struct EvaluationResult {
+    bool complete; //false if the bound was exceeded (the metasolution is then left partially evaluated, see MetaSolution::partially_scored_by,
+                   //or fully evaluated if the aggregate only exceeded it at the end)
+    int score; //aggregated score, if complete
+    int trigger_scenario; //scenario whose score exceeded the bound, if not complete
+};
+
+//scenarios found above the bound during a bounded evaluation, shared by the workers (see Policy::run_positions)
+struct BoundExceedance {
+    int tolerance; //scenarios above the bound that make the aggregate exceed it (Aggregator::exceed_tolerance)
+    std::atomic<int> count{0};
+    std::atomic<int> position; //exploration position at which the tolerance was reached (S while it is not)
+
+    BoundExceedance(int tolerance, int S) : tolerance(tolerance), position(S) {}
+};
+
 // The Policy handles the second decision stage. From Meta solution to Sequence to Schedule. It opperates within a scenario.
 // WARNING : because of the current scope, some functions should be exclusive to "MAX-policies" (extract_sub_metasolution_index for example). small refactor is in order.
 // WARNING : similarly, we require lexicographical order to be defined for the policy
@@ -32,18 +65,64 @@ class Policy {
 public:
     virtual ~Policy() = default;
     std::string name = "undefined_policy";
+    ObjectId object_id; //see ObjectId
+
+    //number of threads used to evaluate scenarios in evaluate_meta (1 = sequential, the default)
+    //WARNING : extract_sequence/transform_to_schedule must then be reentrant (they are called concurrently on different scenarios)
+    void set_threads(int nb_threads) {
+        if (nb_threads < 1) throw std::invalid_argument("Number of threads must be at least 1.");
+        pool = (nb_threads > 1) ? std::make_shared<WorkerPool>(nb_threads) : nullptr;
+    }
+
+    int get_threads() const { return pool ? pool->size() : 1; }
+
+    //how scenario scores are aggregated into the score of a metasolution (max by default). Set it before evaluating : metasolutions already
+    //scored keep their aggregate (the per scenario scores, saved evaluations and score memo do not depend on it). The CP models need MAX
+    void set_aggregator(const Aggregator& new_aggregator) { aggregator = new_aggregator; }
+    const Aggregator& get_aggregator() const { return aggregator; }
+    int aggregate(const std::vector<int>& scores) const { return aggregator.aggregate(scores); }
+
+    //objective of a schedule in a scenario (sumci by default, see Objective.h). Set it before evaluating : scores already computed are not updated
+    //(the score memo is cleared)
+    void set_objective(ObjectiveKind new_objective) {
+        objective = new_objective;
+        if (score_memo) score_memo->clear();
+    }
+    ObjectiveKind get_objective() const { return objective; }
+
+    //remember the scores of metasolutions in base scenarios across evaluations (and across splits of the same instance), up to max_entries
+    //scenario results. 0 disables it (the default). See ScoreMemo
+    void set_score_memo(size_t max_entries) {
+        score_memo = (max_entries > 0) ? std::make_shared<ScoreMemo>(max_entries) : nullptr;
+    }
+
+    //remember the ordered groups (with precedences) of group metasolutions per base scenario, up to max_entries groups, so that metasolutions
+    //sharing groups (e.g. the GSEQ candidates of a list) order them once. 0 disables it (the default). See GroupOrderMemo
+    void set_group_order_memo(size_t max_entries) {
+        group_order_memo = (max_entries > 0) ? std::make_shared<GroupOrderMemo>(max_entries) : nullptr;
+    }
 
     // Pure virtual function to be implemented by derived policies
     virtual Sequence extract_sequence(MetaSolution& metaSolution, const DataInstance& instance, int scenario_id) const = 0;
     virtual bool isLexicographicallySmaller(const Sequence& seq1, const Sequence& seq2, const DataInstance& instance, int scenario_id) const = 0;
     virtual int extract_sub_metasolution_index(const MetaSolution& metaSolution, const DataInstance& instance, int scenario_id) const = 0;    
+
+    //isLexicographicallySmaller on views (e.g. pooled front sequences, see SequencePool), without building Sequences when the policy can
+    virtual bool prefers_sequence(SequenceView seq1, SequenceView seq2, const DataInstance& instance, int scenario_id) const {
+        return this->isLexicographicallySmaller(Sequence(seq1.to_vector()), Sequence(seq2.to_vector()), instance, scenario_id);
+    }
     
     //functions virtual but with default implementation
+
+    //true if the policy expresses a SequenceMetaSolution as its own sequence and schedules it with the default (ERD) transform_to_schedule.
+    //evaluate_meta can then score all scenarios of a single machine instance at once with the vectorized kernel (ScheduleKernels.h)
+    virtual bool uses_sequence_kernel() const { return false; }
+
     //ERD will be shared by probably all policies ()
     virtual Schedule transform_to_schedule(const Sequence& sequence, const DataInstance& instance, int scenario_id) const {
         SingleMachineInstance const& sm_instance = static_cast<const SingleMachineInstance&>(instance);
         const std::vector<int>& tasks = sequence.get_tasks(); // Get tasks in sequence order
-        const std::vector<int>& releaseDates = sm_instance.releaseDates[scenario_id]; // Access release dates for tasks
+        const int* releaseDates = sm_instance.releaseDates.row(scenario_id); // Access release dates for tasks
         const std::vector<int>& durations = sm_instance.durations; // Access task durations
        
         std::vector<int> startTimes(tasks.size());
@@ -62,22 +141,25 @@ public:
         return Schedule(startTimes); 
     }
 
-    // also the way objective is computed ( for each scenario, the sum of end times)
+    //fused evaluation of one scenario : writes the expressed sequence in sequence_out (its memory is reused) and returns its score.
+    //The schedule is only built if schedule_out is given. Default : extract_sequence -> transform_to_schedule -> Schedule::evaluate.
+    //Policies can override it to compute the score while building the sequence (see FIFO/SPT)
+    virtual int extract_and_evaluate(MetaSolution& metaSolution, const DataInstance& instance, int scenario_id, Sequence& sequence_out, Schedule* schedule_out = nullptr) const {
+        sequence_out = this->extract_sequence(metaSolution, instance, scenario_id);
+        Schedule schedule = this->transform_to_schedule(sequence_out, instance, scenario_id);
+        int cost = schedule.evaluate(instance, objective);
+        if (schedule_out) *schedule_out = std::move(schedule);
+        return cost;
+    }
+
+    // also the way objective is computed ( for each scenario, the objective of set_objective, e.g. the sum of end times)
     virtual void define_objective(IloEnv env, IloModel& model, 
                         IloIntervalVarArray2& jobs, const DataInstance& instance, 
                         IloIntExprArray& scenario_scores,  IloIntVar& aggregated_objective) const {
-        SingleMachineInstance const& sm_instance = static_cast<const SingleMachineInstance&>(instance);
-        //objective here is max sumci. Could be other.
-        int nbScenarios = sm_instance.getS();
-        int nbJobs = sm_instance.N;
-        IloIntExprArray completions(env, nbJobs);
-        for (int s = 0; s < nbScenarios; s++) {
-            for (int i = 0; i < nbJobs; i++) {
-                completions[i] = IloEndOf(jobs[s][i]);
-            }
-            scenario_scores[s] = IloSum(completions);
-
-        }
+        //objective here is max over the scenarios.
+        require_max_aggregator();
+        int nbScenarios = instance.getS();
+        define_scenario_scores(env, jobs, instance, scenario_scores);
 
         // Aggregate objectives across scenarios
         for (int s = 0; s < nbScenarios; s++)
@@ -87,92 +169,740 @@ public:
 
 
     //Functions common to all Policies (i.e not virtual)
+    //throws EvaluationBoundExceeded if the bound is exceeded (see evaluate_meta_bounded for the exception free version)
     int evaluate_meta(MetaSolution& metasol, const DataInstance& instance, std::optional<int> exit_bound = std::nullopt, const std::vector<int>* scenario_order = nullptr) {
-        // same for all policies. just extract a schedule and evaluate it for all scenarios.
-        // assume aggregator : max (hence why we can potentially use a bound to stop scenario exploration)
-
-        if (!metasol.scored_by){//metasol was not already scored -> score it and set front/scores for each scenario
-            //special case if metasol is a list of metasol, we recursively have to make sure to evaluate the underlying before
-            if (ListMetaSolutionBase* listMeta = dynamic_cast<ListMetaSolutionBase*>(&metasol)) {
-                listMeta->front_indexes.resize(instance.getS()); //instanciate the indexes of front, is filled in "extract sequence"
-                for (auto submeta : listMeta->get_meta_solutions()){
-                    if (!submeta->scored_by){ //sub metasolution wasn't scored : evaluate it
-                        this->evaluate_meta(*submeta,instance);
-                    }
-                    else if (submeta->scored_by!=this || submeta->scored_for!=&instance){ // else if it is scored but not by this policy, or not for this instance
-                        submeta->reset_evaluation(); //reset it and then score again (via recursive call))
-                        this->evaluate_meta(*submeta, instance);
-                    }
-                    //else do nothing, it is already scored appropriately, we can proceed
-                }
-            }
+        EvaluationResult result = evaluate_meta_bounded(metasol, instance, exit_bound, scenario_order);
+        if (!result.complete) throw EvaluationBoundExceeded(result.trigger_scenario);
+        return result.score;
+    }
 
-            // Iterate over all scenarios in the DataInstance
-            int maxCost = 0; //could use int-min aswell depends on if we are ok with negative values . sumci can't be negative.
-            metasol.scores.resize(instance.getS());
-            metasol.front_sequences.resize(instance.getS());
-        
-            for (int k=0; k<instance.getS(); k++) { //for each scenario, get sequence and score, to aggregate
-                int i = scenario_order ? (*scenario_order)[k] : k; //if a custom order is provided, use it to change scenario exploration order (this can help with early stopping via exit_bound)
-                Sequence seq = this->extract_sequence(metasol, instance, i); 
-                Schedule schedule = this->transform_to_schedule(seq, instance, i);
-                // Evaluate the schedule for the current scenario
-                int cost = schedule.evaluate(instance);
-                //set metasol data
-                metasol.scores[i]=cost;
-                metasol.front_sequences[i] = seq; 
-                // Update the maximum cost
-                if (cost > maxCost) {
-                    maxCost = cost;
-                    if (exit_bound.has_value() && maxCost > exit_bound.value()){ //given max aggregator, if the score in a scenario gets bigger than the bound, we know eval will return something bigger than bound
-                        throw EvaluationBoundExceeded(i);
-                    }
+    //evaluate_meta keeping the scores only, no front sequences. A later evaluate_meta evaluates again to record the fronts
+    int evaluate_scores(MetaSolution& metasol, const DataInstance& instance, std::optional<int> exit_bound = std::nullopt, const std::vector<int>* scenario_order = nullptr) {
+        EvaluationResult result = evaluate_meta_bounded(metasol, instance, exit_bound, scenario_order, false);
+        if (!result.complete) throw EvaluationBoundExceeded(result.trigger_scenario);
+        return result.score;
+    }
+
+    //evaluate_meta reporting an exceeded bound in the result instead of throwing. The scenarios evaluated so far are kept :
+    //evaluating again with this policy and instance only evaluates the missing ones
+    EvaluationResult evaluate_meta_bounded(MetaSolution& metasol, const DataInstance& instance, std::optional<int> exit_bound = std::nullopt, const std::vector<int>* scenario_order = nullptr,
+                                           bool keep_fronts = true) {
+        // same for all policies. just extract a schedule and evaluate it for all scenarios, then aggregate.
+        if (!this->start_evaluation(metasol, instance, keep_fronts)) return within_bound(metasol, exit_bound); //metasol was scored by this policy for this instance already, just send result.
+
+        // Iterate over all scenarios in the DataInstance
+        int S = instance.getS();
+
+        //with a bound, exploration stops once enough scenarios exceed it (shared between workers)
+        BoundExceedance exceedance(aggregator.exceed_tolerance(S), S);
+        auto evaluate_block = [&](int k_begin, int k_end) {
+            this->evaluate_positions(metasol, instance, k_begin, k_end, scenario_order, exit_bound, exceedance);
+        };
+
+        bool use_kernel = this->kernel_applies(metasol, instance);
+
+        //scenarios already known from the memo are filled in and skipped like resumed ones (the kernel is faster than the lookups)
+        Fingerprint fingerprint = (score_memo && !use_kernel) ? metasol.fingerprint() : Fingerprint();
+        std::vector<char> known; //known[i] : score of scenario i did not come from this evaluation
+        if (fingerprint.memoized()) memo_lookup(metasol, instance, fingerprint, known);
+
+        if (use_kernel) {
+            //same sequence in every scenario : all scenarios at once, then check the bound in exploration order
+            this->evaluate_fixed_sequence(static_cast<SequenceMetaSolution&>(metasol), static_cast<const SingleMachineInstance&>(instance));
+            if (exit_bound.has_value()) {
+                int count = 0;
+                for (int k = 0; k < S; k++) {
+                    int i = scenario_order ? (*scenario_order)[k] : k;
+                    if (metasol.scores[i] > exit_bound.value() && ++count == exceedance.tolerance) { exceedance.position.store(k); break; }
                 }
             }
-            metasol.score = maxCost; //set metasol score
-            metasol.scored_by = this;
-            metasol.scored_for = &instance;
-            return maxCost; // Return the aggregated value (max)
         }
-        else if (metasol.scored_by!=this || metasol.scored_for!=&instance){ // else if it is scored but not by this policy, or not for this instance
-            //reset evaluation (carefull, if it's a list, have to call list_specific_reset.)
-            if (ListMetaSolutionBase* listMeta = dynamic_cast<ListMetaSolutionBase*>(&metasol)) {
-                listMeta->reset_evaluation();
-            }
-            else {
-                metasol.reset_evaluation(); //reset it and then score (via recursive call))
-            }
-            return this->evaluate_meta(metasol, instance);
+        else if (pool && S > 1) {
+            //small blocks of positions, grabbed in order by the workers : the first scenarios of the order are explored first
+            int block = std::max(1, S / (8 * pool->size()));
+            int nb_blocks = (S + block - 1) / block;
+            pool->parallel_for(nb_blocks, [&](int b) { evaluate_block(b * block, std::min(S, (b + 1) * block)); });
         }
-        else{ //metasol was scored by this policy for this instance already, just send result.
-            return metasol.score;
+        else {
+            evaluate_block(0, S);
         }
+
+        if (fingerprint.memoized()) memo_store(metasol, instance, fingerprint, known);
+        EvaluationResult result = this->finish_evaluation(metasol, instance, exceedance.position.load(), scenario_order);
+        return result.complete ? within_bound(metasol, exit_bound) : result;
     };
+
+    //evaluates all candidates in instance (as evaluate_meta without bound, candidates already scored are not evaluated again) and returns
+    //their scores as a dense matrix. Much faster than one evaluate_meta per candidate for large pools, see evaluate_all
+    ScoreMatrix evaluate_many(const std::vector<MetaSolution*>& candidates, const DataInstance& instance) {
+        this->evaluate_all(candidates, instance);
+        const int M = candidates.size();
+        const int S = instance.getS();
+        ScoreMatrix matrix;
+        matrix.nb_candidates = M;
+        matrix.nb_scenarios = S;
+        matrix.scores.resize(static_cast<size_t>(M) * S);
+        matrix.front_ids.resize(static_cast<size_t>(M) * S);
+        matrix.aggregates.resize(M);
+        for (int m = 0; m < M; m++) {
+            const MetaSolution& candidate = *candidates[m];
+            std::copy(candidate.scores.begin(), candidate.scores.end(), matrix.scores.data() + static_cast<size_t>(m) * S);
+            for (int s = 0; s < S; s++) matrix.front_ids[static_cast<size_t>(m) * S + s] = candidate.front_sequences[s];
+            matrix.aggregates[m] = candidate.score;
+        }
+        return matrix;
+    }
             
     int find_limiting_scenario(const MetaSolution& metasol, const DataInstance& instance) const{ //finds the limiting scenario of a listMetaSOlution
         // same for all policies. Similar to evaluate_meata but keep the scenario culprit.
-        // assume aggregator : max 
 
         //assert metasolution type is listmeta.
         if (!dynamic_cast<const ListMetaSolutionBase*>(&metasol)) {
             throw std::runtime_error("MetaSolution must be of type ListMetaSolutionBase.");
         } 
 
-        // Iterate over all scenarios in the DataInstance to find the worst one
-        int maxCost = 0; //could use int-min aswell depends on if we are ok with negative values . sumci can't be negative.
-        int limiting_index = 0; 
-        int limiting_scenario = 0; 
-        for (int i=0; i<instance.getS(); i++) { 
+        // the worst scenario (the scenario at the quantile for a quantile aggregator)
+        (void)instance;
+        return aggregator.limiting_scenario(metasol.scores);
+    }
+
+protected:
+    std::shared_ptr<WorkerPool> pool = nullptr; //scenario evaluation workers (null when sequential)
+    Aggregator aggregator; //see set_aggregator
+    ObjectiveKind objective = ObjectiveKind::SUM_COMPLETION; //see set_objective
+    std::shared_ptr<ScoreMemo> score_memo = nullptr; //see set_score_memo
+    std::shared_ptr<GroupOrderMemo> group_order_memo = nullptr; //see set_group_order_memo
+
+    //first step of an evaluation : brings metasol to the scenarios of instance, resuming a partial or saved evaluation when possible,
+    //and evaluates the subs of a list. Returns false if metasol is already scored by this policy for this instance
+    bool start_evaluation(MetaSolution& metasol, const DataInstance& instance, bool keep_fronts = true) {
+        const uint64_t policy_id = object_id.get();
+        const uint64_t instance_id = instance.object_id.get();
+        if (metasol.evaluated_instance_id == instance_id && metasol.evaluated_revision != instance.get_scenario_revision()) {
+            bool max_aggregate = metasol.evaluated_policy_id == policy_id && aggregator.get_kind() == Aggregator::Kind::MAX;
+            metasol.follow_scenario_changes(instance, max_aggregate); //scenarios were appended/retired since : keep what is still valid
+        }
+        auto lacks_fronts = [&]() { return keep_fronts && metasol.fronts_omitted; };
+        if (metasol.scored_by) {
+            if (metasol.evaluation_of(policy_id, instance_id)) {
+                if (!lacks_fronts()) return false;
+                metasol.clear_evaluation();
+            }
+            else metasol.stash_evaluation(); //scored by another policy or for another instance : keep it for when we come back to that policy/instance
+        }
+
+        bool resume = (metasol.partially_scored_by && metasol.evaluation_of(policy_id, instance_id) && !lacks_fronts());
+        if (!resume) {
+            if (metasol.partially_scored_by) metasol.clear_evaluation(); //partial evaluation of another policy/instance
+            if (metasol.restore_evaluation(policy_id, instance_id)) { //evaluated before for this pair
+                if (lacks_fronts()) metasol.clear_evaluation();
+                else {
+                    if (metasol.evaluated_revision != instance.get_scenario_revision()) metasol.follow_scenario_changes(instance, aggregator.get_kind() == Aggregator::Kind::MAX);
+                    if (metasol.scored_by) return false;
+                    resume = metasol.partially_scored_by != nullptr; //only the appended scenarios are left (nothing if the scenarios were replaced)
+                }
+            }
+        }
+        //special case if metasol is a list of metasol, we recursively have to make sure to evaluate the underlying before
+        if (ListMetaSolutionBase* listMeta = dynamic_cast<ListMetaSolutionBase*>(&metasol)) {
+            listMeta->front_indexes.resize(instance.getS()); //instanciate the indexes of front, is filled in "extract sequence"
+            std::vector<MetaSolution*> unscored; //sub metasolutions not scored (or not by this policy, or not for this instance, or not for its current scenarios, or without fronts)
+            for (auto submeta : listMeta->get_meta_solutions()){
+                if (!submeta->scored_by || !submeta->evaluation_of(policy_id, instance_id) || submeta->evaluated_revision!=instance.get_scenario_revision() || submeta->fronts_omitted) unscored.push_back(submeta);
+                //else do nothing, it is already scored appropriately, we can proceed
+            }
+            this->evaluate_all(unscored, instance); //the list selects among their fronts
+        }
+
+        int S = instance.getS();
+        if (!resume) {
+            metasol.scores.assign(S, MetaSolution::NOT_EVALUATED);
+            metasol.evaluated_revision = instance.get_scenario_revision();
+            metasol.fronts_omitted = !keep_fronts;
+        }
+        if (!metasol.fronts_omitted) metasol.front_sequences.resize(S);
+        return true;
+    }
+
+    //last step of an evaluation : aggregates the scores, or leaves metasol partially evaluated if the bound was exceeded at exploration
+    //position exceeded_position (S if it was not)
+    EvaluationResult finish_evaluation(MetaSolution& metasol, const DataInstance& instance, int exceeded_position, const std::vector<int>* scenario_order) {
+        metasol.scores_changed();
+        if (exceeded_position < instance.getS()) {
+            metasol.partially_scored_by = this;
+            metasol.partially_scored_for = &instance;
+            metasol.evaluated_policy_id = object_id.get();
+            metasol.evaluated_instance_id = instance.object_id.get();
+            return {false, 0, scenario_order ? (*scenario_order)[exceeded_position] : exceeded_position};
+        }
+
+        metasol.score = aggregator.aggregate(metasol.scores); //aggregate once all scenarios are done
+        metasol.scored_by = this;
+        metasol.scored_for = &instance;
+        metasol.evaluated_policy_id = object_id.get();
+        metasol.evaluated_instance_id = instance.object_id.get();
+        metasol.partially_scored_by = nullptr;
+        metasol.partially_scored_for = nullptr;
+        return {true, metasol.score, -1}; // Return the aggregated value
+    }
+
+    //result of a complete evaluation of metasol : the bound is exceeded if its aggregate is above it (see Aggregator::exceed_tolerance)
+    EvaluationResult within_bound(const MetaSolution& metasol, std::optional<int> exit_bound) const {
+        if (exit_bound.has_value() && metasol.score > exit_bound.value()) return {false, metasol.score, aggregator.limiting_scenario(metasol.scores)};
+        return {true, metasol.score, -1};
+    }
+
+    //the CP models (define_objective) minimise the max over the scenarios
+    void require_max_aggregator() const {
+        if (aggregator.get_kind() != Aggregator::Kind::MAX) throw std::runtime_error("CP models only minimise the max over the scenarios : use the MAX aggregator.");
+    }
+
+    //true if metasol is scored in all scenarios at once by the cross-scenario kernel (see uses_sequence_kernel)
+    bool kernel_applies(const MetaSolution& metasol, const DataInstance& instance) const {
+        return dynamic_cast<const SequenceMetaSolution*>(&metasol) && this->uses_sequence_kernel() && instance.type == InstanceType::SINGLE_MACHINE
+            && objective == ObjectiveKind::SUM_COMPLETION; //the kernel computes sumci
+    }
+
+    //evaluates all candidates without bound, with their fronts. Tiles of candidates x scenarios keep a block of scenarios in L2
+    void evaluate_all(const std::vector<MetaSolution*>& candidates, const DataInstance& instance) {
+        const int S = instance.getS();
+        std::vector<MetaSolution*> pending; //candidates left to the tiles
+        std::vector<Fingerprint> fingerprints;
+        std::vector<std::vector<char>> known; //see memo_lookup
+        std::unordered_set<MetaSolution*> started; //a candidate given twice is evaluated once
+        for (MetaSolution* candidate : candidates) {
+            if (!started.insert(candidate).second || !this->start_evaluation(*candidate, instance)) continue;
+            if (this->kernel_applies(*candidate, instance)) { //already vectorized over the scenarios
+                this->evaluate_fixed_sequence(static_cast<SequenceMetaSolution&>(*candidate), static_cast<const SingleMachineInstance&>(instance));
+                this->finish_evaluation(*candidate, instance, S, nullptr);
+                continue;
+            }
+            pending.push_back(candidate);
+            fingerprints.push_back(score_memo ? candidate->fingerprint() : Fingerprint());
+            known.emplace_back();
+            if (fingerprints.back().memoized()) memo_lookup(*candidate, instance, fingerprints.back(), known.back());
+        }
+        const int P = pending.size();
+        if (P == 0) return;
+
+        //scenario tiles sized for L2 (about 3 ints per task and scenario), candidate tiles small enough to keep every thread busy
+        const int threads = get_threads();
+        int scenario_tile = std::max(8, (1 << 18) / (12 * std::max(1, instance.getN())));
+        int candidate_tile = 16;
+        auto nb_tiles = [&]() { return ((P + candidate_tile - 1) / candidate_tile) * ((S + scenario_tile - 1) / scenario_tile); };
+        while (threads > 1 && candidate_tile > 1 && nb_tiles() < 8 * threads) candidate_tile /= 2;
+        while (threads > 1 && scenario_tile > 1 && nb_tiles() < 8 * threads) scenario_tile = (scenario_tile + 1) / 2;
+        const int nb_candidate_tiles = (P + candidate_tile - 1) / candidate_tile;
+
+        BoundExceedance unbounded(1, S); //no bound : never reached, shared by all candidates
+        auto run_tile = [&](int t) { //consecutive tiles share their scenarios (grabbed at the same time by the workers)
+            int s_begin = (t / nb_candidate_tiles) * scenario_tile;
+            int s_end = std::min(S, s_begin + scenario_tile);
+            int m_begin = (t % nb_candidate_tiles) * candidate_tile;
+            int m_end = std::min(P, m_begin + candidate_tile);
+            for (int m = m_begin; m < m_end; m++) {
+                this->evaluate_positions(*pending[m], instance, s_begin, s_end, nullptr, std::nullopt, unbounded);
+            }
+        };
+        if (pool) pool->parallel_for(nb_tiles(), run_tile);
+        else for (int t = 0; t < nb_tiles(); t++) run_tile(t);
+
+        for (int m = 0; m < P; m++) {
+            if (fingerprints[m].memoized()) memo_store(*pending[m], instance, fingerprints[m], known[m]);
+            this->finish_evaluation(*pending[m], instance, S, nullptr);
+        }
+    }
+
+    //fills the scenarios of metasol found in the memo. known[i] is set for them and for the scenarios that were already evaluated.
+    //An entry without its front still gives the score : if fronts are kept, only the front is extracted again (and memo_store completes the entry)
+    void memo_lookup(MetaSolution& metasol, const DataInstance& instance, const Fingerprint& fingerprint, std::vector<char>& known) const {
+        int S = instance.getS();
+        std::vector<int>* indexes = metasol.evaluation_indexes();
+        known.assign(S, 0);
+        std::vector<int> missing_fronts;
+        ScoreMemo::Entry entry;
+        for (int i = 0; i < S; i++) {
+            if (metasol.scores[i] != MetaSolution::NOT_EVALUATED) { known[i] = 1; continue; } //resumed evaluation
+            if (score_memo->find({fingerprint.hash, fingerprint.check, instance.base_instance_id, instance.get_base_scenario_id(i)}, entry)) {
+                metasol.scores[i] = entry.score;
+                if (indexes) (*indexes)[i] = entry.front_index;
+                if (metasol.fronts_omitted) SequencePool::global().release(entry.front); //find gave us a reference
+                else if (!entry.has_front) { missing_fronts.push_back(i); continue; }
+                else metasol.front_sequences.adopt(i, entry.front);
+                known[i] = 1;
+            }
+        }
+        auto extract_front = [&](int m) {
+            int i = missing_fronts[m];
+            if (ListMetaSolutionBase* listMeta = dynamic_cast<ListMetaSolutionBase*>(&metasol)) { //the selected sub metasolution is known
+                metasol.front_sequences.set(i, listMeta->get_meta_solutions()[(*indexes)[i]]->front_sequences[i]);
+            }
+            else metasol.front_sequences.store(i, this->extract_sequence(metasol, instance, i).get_tasks());
+        };
+        const int nb_missing = missing_fronts.size();
+        if (pool && nb_missing > 1) pool->parallel_for(nb_missing, extract_front);
+        else for (int m = 0; m < nb_missing; m++) extract_front(m);
+    }
+
+    //saves the scenarios of metasol evaluated since memo_lookup
+    void memo_store(MetaSolution& metasol, const DataInstance& instance, const Fingerprint& fingerprint, const std::vector<char>& known) const {
+        std::vector<int>* indexes = metasol.evaluation_indexes();
+        for (int i = 0; i < instance.getS(); i++) {
+            if (known[i] || metasol.scores[i] == MetaSolution::NOT_EVALUATED) continue;
+            score_memo->insert({fingerprint.hash, fingerprint.check, instance.base_instance_id, instance.get_base_scenario_id(i)},
+                               {metasol.scores[i], indexes ? (*indexes)[i] : -1, !metasol.fronts_omitted, metasol.fronts_omitted ? SequencePool::EMPTY : metasol.front_sequences[i]}); //the memo takes its own reference
+        }
+    }
+
+    //objective of each scenario in the CP models (see set_objective)
+    void define_scenario_scores(IloEnv env, IloIntervalVarArray2& jobs, const DataInstance& instance, IloIntExprArray& scenario_scores) const {
+        int nbJobs = instance.getN();
+        const std::vector<int>& dueDates = instance.get_due_dates();
+        IloIntExprArray completions(env, nbJobs);
+        for (int s = 0; s < instance.getS(); s++) {
+            for (int i = 0; i < nbJobs; i++) {
+                switch (objective) {
+                    case ObjectiveKind::WEIGHTED_COMPLETION: completions[i] = instance.weights[i] * IloEndOf(jobs[s][i]); break;
+                    case ObjectiveKind::TOTAL_TARDINESS: completions[i] = IloMax(IloEndOf(jobs[s][i]) - dueDates[i], 0); break;
+                    default: completions[i] = IloEndOf(jobs[s][i]);
+                }
+            }
+            scenario_scores[s] = (objective == ObjectiveKind::MAKESPAN) ? IloMax(completions) : IloSum(completions);
+        }
+    }
+
+    //objective of the ERD schedule of a sequence (same as transform_to_schedule + Schedule::evaluate, without the schedule)
+    template <typename Objective>
+    static int sequence_objective(SequenceView tasks, const SingleMachineInstance& sm_instance, int scenario_id) {
+        const int* releaseDates = sm_instance.releaseDates.row(scenario_id);
+        const int* durations = sm_instance.durations.data();
+        const ObjectiveData data = ObjectiveData::of(sm_instance);
+        int currentTime = 0;
+        int value = 0;
+        for (int task : tasks) {
+            currentTime = std::max(currentTime, releaseDates[task]) + durations[task];
+            value = Objective::add(value, task, currentTime, data);
+        }
+        return value;
+    }
+
+    //sequence_objective, giving up (NOT_EVALUATED) as soon as the objective is known to exceed abort_above (see Objective.h lower_bound)
+    template <typename Objective>
+    static int bounded_sequence_objective(SequenceView tasks, const SingleMachineInstance& sm_instance, int scenario_id, const GroupPrecedenceGraph& graph, int abort_above) {
+        const int* releaseDates = sm_instance.releaseDates.row(scenario_id);
+        const int* durations = sm_instance.durations.data();
+        const ObjectiveData data = ObjectiveData::of(sm_instance);
+        const int n = tasks.size();
+        int currentTime = 0;
+        int value = 0;
+        for (int c = 0; c < n; c++) {
+            int task = tasks[c];
+            currentTime = std::max(currentTime, releaseDates[task]) + durations[task];
+            value = Objective::add(value, task, currentTime, data);
+            if (Objective::lower_bound(value, currentTime, n - 1 - c, graph.spt_completion_bound.data()) > abort_above) return MetaSolution::NOT_EVALUATED;
+        }
+        return value;
+    }
+
+    //emits (emit(task)) the tasks of group k of a GroupMetaSolution in topological order, always picking the first available task
+    //of the group sorted with less(task1, task2). Precedences come from the cached group graph, available tasks are a bitmask over sorted positions.
+    template <typename Less, typename Emit>
+    static void sorted_toposort(const std::vector<int>& taskGroup, const GroupPrecedenceGraph& graph, int k, Less&& less, EvaluationScratch& scratch, Emit&& emit) {
+        EvaluationScratch::Frame frame(scratch);
+        const int g = taskGroup.size();
+        int* order = scratch.alloc(g); //order[p] : position in the group of the task at sorted position p
+        std::iota(order, order + g, 0);
+        std::sort(order, order + g, [&](int a, int b) { return less(taskGroup[a], taskGroup[b]); });
+        if (graph.is_free(k)) { //no precedence inside the group : sorted order
+            for (int p = 0; p < g; p++) emit(taskGroup[order[p]]);
+            return;
+        }
+
+        const int base = graph.node_begin[k];
+        int* sorted_position = scratch.alloc(g);
+        int* remaining_preds = scratch.alloc(g);
+        for (int p = 0; p < g; p++) sorted_position[order[p]] = p;
+        std::copy(graph.pred_count.begin() + base, graph.pred_count.begin() + base + g, remaining_preds);
+        const int nb_words = (g + 63) / 64;
+        uint64_t* available = scratch.alloc_words(nb_words); //bit p : task at sorted position p is available
+        for (int i = 0; i < g; i++) {
+            if (remaining_preds[i] == 0) available[sorted_position[i] >> 6] |= uint64_t(1) << (sorted_position[i] & 63);
+        }
+
+        int word = 0; //no available task before this word
+        for (int emitted = 0; emitted < g; emitted++) {
+            while (word < nb_words && available[word] == 0) word++;
+            if (word == nb_words) break; //cycle in the precedences, cannot happen with valid instances
+            int p = (word << 6) + __builtin_ctzll(available[word]);
+            available[word] &= available[word] - 1; //remove lowest bit
+            int i = order[p];
+            emit(taskGroup[i]);
+            for (int e = graph.succ_begin[base + i]; e < graph.succ_begin[base + i + 1]; e++) {
+                int j = graph.succ[e];
+                if (--remaining_preds[j] == 0) {
+                    int q = sorted_position[j];
+                    available[q >> 6] |= uint64_t(1) << (q & 63);
+                    word = std::min(word, q >> 6);
+                }
+            }
+        }
+    }
+
+    //writes the tasks of every group of a GroupMetaSolution in sequence (groups one after the other), each group sorted with less and its precedences respected.
+    //global_order lists all N tasks of the scenario sorted with less (e.g. DataInstance::get_release_order) : groups without internal precedence are then
+    //filled by a single pass over it (O(N) for all of them instead of sorting each group), the other groups go through sorted_toposort
+    //(or are copied from the group order memo, when set : less must then be the release date order of the scenario)
+    template <typename Less>
+    void ordered_group_extraction(const std::vector<std::vector<int>>& taskGroups, const GroupPrecedenceGraph& graph, const DataInstance& instance, int scenario_id,
+                                  const int* global_order, Less&& less, EvaluationScratch& scratch, int* sequence) const {
+        const int N = instance.getN();
+        if (graph.has_free_group) {
+            EvaluationScratch::Frame frame(scratch);
+            int* next = scratch.alloc(taskGroups.size()); //next output slot of each group
+            std::copy(graph.node_begin.begin(), graph.node_begin.end() - 1, next);
+            for (int p = 0; p < N; p++) {
+                int task = global_order[p];
+                int k = graph.group_of[task];
+                if (k >= 0 && graph.is_free(k)) sequence[next[k]++] = task;
+            }
+        }
+        for (size_t k = 0; k < taskGroups.size(); k++) {
+            if (graph.is_free(k)) continue;
+            int c = graph.node_begin[k];
+            const int g = taskGroups[k].size();
+            if (!group_order_memo || g < GroupOrderMemo::MIN_GROUP_SIZE) {
+                sorted_toposort(taskGroups[k], graph, k, less, scratch, [&](int task) { sequence[c++] = task; });
+                continue;
+            }
+            GroupOrderMemo::Key key{graph.group_hash[k], instance.base_instance_id, instance.get_base_scenario_id(scenario_id)};
+            if (group_order_memo->find(key, sequence + c, g, [&](int task) { return graph.group_of[task] == static_cast<int>(k); })) {
+                continue; //same tasks : same order (ties are broken by task id)
+            }
+            sorted_toposort(taskGroups[k], graph, k, less, scratch, [&](int task) { sequence[c++] = task; });
+            group_order_memo->insert(key, sequence + graph.node_begin[k], g);
+        }
+    }
+
+    //evaluates the scenarios at positions [k_begin, k_end) of the exploration order. StaticPolicy overrides it with a statically dispatched loop
+    virtual void evaluate_positions(MetaSolution& metasol, const DataInstance& instance, int k_begin, int k_end, const std::vector<int>* scenario_order,
+                                    std::optional<int> exit_bound, BoundExceedance& exceedance) const {
+        run_positions(metasol, k_begin, k_end, scenario_order, exit_bound, exceedance, [&](int scenario_id, auto& fronts) {
+            Sequence& sequence = extraction_buffer();
+            int cost = this->extract_and_evaluate(metasol, instance, scenario_id, sequence);
+            put_front(fronts, scenario_id, sequence.get_tasks());
+            return cost;
+        });
+    }
+
+    //scenario loop of evaluate_positions. evaluate_one(scenario_id, fronts) puts the front in fronts (see put_front) and returns the score,
+    //or NOT_EVALUATED if it gave up above exit_bound
+    template <typename EvaluateOne>
+    static void run_positions(MetaSolution& metasol, int k_begin, int k_end, const std::vector<int>* scenario_order,
+                              std::optional<int> exit_bound, BoundExceedance& exceedance, EvaluateOne&& evaluate_one) {
+        NoFronts omitted;
+        for (int k = k_begin; k < k_end; k++) {
+            if (exceedance.position.load(std::memory_order_relaxed) < k) return; //scenarios explored before already exceeded the bound
+            int i = scenario_order ? (*scenario_order)[k] : k; //custom exploration order (helps early stopping via exit_bound)
             int cost = metasol.scores[i];
-            // Update the maximum cost
-            if (cost > maxCost) {
-                maxCost = cost;
-                limiting_scenario = i;
+            if (cost == MetaSolution::NOT_EVALUATED) { //not known from a previous evaluation
+                cost = metasol.fronts_omitted ? evaluate_one(i, omitted) : evaluate_one(i, metasol.front_sequences);
+                metasol.scores[i]=cost;
+            }
+            if (cost == MetaSolution::NOT_EVALUATED || (exit_bound.has_value() && cost > exit_bound.value())){ //see Aggregator::exceed_tolerance
+                if (exceedance.count.fetch_add(1) + 1 < exceedance.tolerance) continue;
+                int expected = exceedance.position.load();
+                while (k < expected && !exceedance.position.compare_exchange_weak(expected, k)) {}
+                return;
+            }
+        }
+    }
+
+    //scores a SequenceMetaSolution in all scenarios with the cross-scenario kernel (sumci objective, ERD schedule),
+    //or the max-plus scan kernel for very long sequences in few scenarios (see scan_applies)
+    void evaluate_fixed_sequence(SequenceMetaSolution& seqMeta, const SingleMachineInstance& sm_instance) const {
+        const std::vector<int>& tasks = seqMeta.get_sequence().get_tasks();
+        int S = sm_instance.getS();
+        if (this->scan_applies(tasks.size(), S)) {
+            this->scan_fixed_sequence(tasks, sm_instance, seqMeta.scores.data());
+        }
+        else {
+            const int* releaseByTask = sm_instance.get_release_dates_by_task();
+            int stride = sm_instance.get_task_major_stride();
+            auto run = [&](int s_begin, int s_end) {
+                sequence_sumci_kernel(tasks.data(), tasks.size(), sm_instance.durations.data(), releaseByTask, stride, s_begin, s_end, seqMeta.scores.data());
+            };
+            int block = 256; //scenarios per worker task (multiple of the vector width)
+            if (pool && S > block) {
+                pool->parallel_for((S + block - 1) / block, [&](int b) { run(b * block, std::min(S, (b + 1) * block)); });
+            }
+            else {
+                run(0, S);
+            }
+        }
+        if (seqMeta.fronts_omitted) return;
+        PooledSequence pooled(SequencePool::global().intern(tasks)); //one live handle for all scenarios (see the capacity of SequencePool)
+        seqMeta.front_sequences.fill(pooled.get());
+    }
+
+    static constexpr int SCAN_MIN_TASKS = 4096; //shorter sequences are left to the cross-scenario kernel
+    static constexpr int SCAN_MIN_BLOCK = 1024; //tasks per block of the scan kernel, at least
+
+    //true if the scan kernel (parallel over the tasks) should score a sequence of n tasks in S scenarios instead of the cross-scenario kernel
+    //(parallel over the scenarios, by blocks of 256 for the threads). Measured single thread costs, in tenths of ns per task : about 16 per
+    //scenario for the scan, 14 per scenario below a vector of scenarios and 23 per vector of 8 for the cross-scenario kernel. The scan
+    //only wins when its blocks can be spread over threads the cross-scenario kernel cannot use (few scenarios)
+    bool scan_applies(int n, int S) const {
+        const int threads = get_threads();
+        if (threads == 1 || n < SCAN_MIN_TASKS) return false;
+        const int scan_units = std::min(threads, S * ((n + SCAN_MIN_BLOCK - 1) / SCAN_MIN_BLOCK)); //threads each kernel can keep busy
+        const int cross_units = std::min(threads, (S + 255) / 256);
+        return 16LL * S * cross_units < (14LL * (S % 8) + 23LL * (S / 8)) * scan_units; //scan time < cross-scenario time
+    }
+
+    //sumci of the sequence tasks in every scenario with the max-plus scan kernel (ScheduleKernels.h) : the sequence is cut in blocks of tasks,
+    //each (scenario, block) pair is scanned on its own, then the start of each block is known and the blocks are summed, spread over the threads
+    void scan_fixed_sequence(const std::vector<int>& tasks, const SingleMachineInstance& sm_instance, int* out) const {
+        const int n = tasks.size();
+        const int S = sm_instance.getS();
+        const int block = std::max(SCAN_MIN_BLOCK, (n + 4 * get_threads() - 1) / (4 * get_threads())); //a few blocks per thread
+        const int nb_blocks = (n + block - 1) / block;
+        const int* durations = sm_instance.durations.data();
+        std::vector<int> prefix(n); //durations in sequence order, summed (same in every scenario)
+        int total = 0;
+        for (int k = 0; k < n; k++) prefix[k] = (total += durations[tasks[k]]);
+
+        std::vector<int> completions(static_cast<size_t>(S) * n); //of each block started at time 0, scenario-major
+        std::vector<int> starts(static_cast<size_t>(S) * nb_blocks);
+        std::vector<int> sums(static_cast<size_t>(S) * nb_blocks);
+        auto run = [&](const std::function<void(int)>& fn) {
+            if (pool) pool->parallel_for(S * nb_blocks, fn);
+            else for (int t = 0; t < S * nb_blocks; t++) fn(t);
+        };
+        run([&](int t) {
+            int s = t / nb_blocks, b = t % nb_blocks;
+            max_plus_scan_block(tasks.data(), b * block, std::min(n, (b + 1) * block), durations, sm_instance.releaseDates.row(s), completions.data() + static_cast<size_t>(s) * n);
+        });
+        for (int s = 0; s < S; s++) { //start of each block : the completion of the block before, started at its own start
+            const int* completion = completions.data() + static_cast<size_t>(s) * n;
+            int start = 0;
+            for (int b = 0; b < nb_blocks; b++) {
+                starts[s * nb_blocks + b] = start;
+                int k_begin = b * block, k_end = std::min(n, (b + 1) * block);
+                start = std::max(start + prefix[k_end - 1] - (k_begin > 0 ? prefix[k_begin - 1] : 0), completion[k_end - 1]);
             }
         }
-        return limiting_scenario;
+        run([&](int t) {
+            int s = t / nb_blocks, b = t % nb_blocks;
+            sums[t] = max_plus_block_sumci(prefix.data(), completions.data() + static_cast<size_t>(s) * n, b * block, std::min(n, (b + 1) * block), starts[t]);
+        });
+        for (int s = 0; s < S; s++) {
+            unsigned sum = 0; //wraps like the other kernels
+            for (int b = 0; b < nb_blocks; b++) sum += static_cast<unsigned>(sums[s * nb_blocks + b]);
+            out[s] = static_cast<int>(sum);
+        }
+    }
+
+    //front sink of an evaluation without fronts (see evaluate_scores)
+    struct NoFronts {};
+
+    //writes the front sequence of scenario s : in the front sequences of a metasolution (pooled, a handle is shared as is), in a plain Sequence, or nowhere
+    static void put_front(FrontSequences& fronts, int s, SequenceView tasks) { fronts.store(s, tasks); }
+    static void put_front(FrontSequences& fronts, int s, SequenceHandle handle) { fronts.set(s, handle); }
+    static void put_front(Sequence& sequence, int, SequenceView tasks) { sequence.get_tasks_modifiable().assign(tasks.begin(), tasks.end()); }
+    static void put_front(Sequence& sequence, int, SequenceHandle handle) { put_front(sequence, 0, SequencePool::global().view(handle)); }
+    static void put_front(NoFronts&, int, SequenceView) {}
+    static void put_front(NoFronts&, int, SequenceHandle) {}
+
+    //sequence built by an evaluation before it is pooled, one per thread
+    static Sequence& extraction_buffer() {
+        thread_local Sequence sequence;
+        return sequence;
+    }
+};
+
+
+// Base of the concrete policies (CRTP) : statically dispatched evaluation.
+// The metasolution type, the instance type and the objective (see Policy::set_objective) are resolved once per block of scenarios
+// (not once per scenario), then the scenario loop calls the non virtual functions of Derived directly, so they can be inlined.
+// Derived declares the instance type it works on (using Instance = ...) and provides :
+//   void check_instance(const DataInstance&) const : throws if the instance type is not supported
+//   void extract_group(const GroupMetaSolution&, const Instance&, int scenario_id, std::vector<int>& sequence, EvaluationScratch&) const : policy sequence of a group metasolution
+//   template <typename Objective> int score_sequence(SequenceView tasks, const Instance&, int scenario_id, EvaluationScratch&) const : objective of a sequence in a scenario
+//   bool prefers(SequenceView tasks1, SequenceView tasks2, const Instance&, int scenario_id) const : tasks1 strictly preferred (lex order of the policy)
+// and optionally template <typename Objective> int extract_group_scored(..., int abort_above) (arguments of extract_group, then a bound) to compute the score
+// while building the sequence. It may give up and return NOT_EVALUATED as soon as the score is known to be above abort_above (bounded evaluation).
+// Derived may also provide const int* order_classes(const Instance&) const (order class of each scenario, see ScenarioMatrix::row_order_classes)
+// when its extractions and preferences only depend on the order of the release dates : scenarios of a class evaluated in the same block then reuse
+// the extracted sequence (or the selected front of a list), only the objective is recomputed.
+// Temporary memory comes from the EvaluationScratch of the evaluating thread (no allocation in the scenario loop).
+template <typename Derived>
+class StaticPolicy : public Policy {
+public:
+    Sequence extract_sequence(MetaSolution& metaSolution, const DataInstance& instance, int scenario_id) const override {
+        if(metaSolution.scored_by){throw std::runtime_error("Extracting sequence but metasol is already scored.");} //if already scored, why don't we just get the stored result?
+        derived().check_instance(instance);
+        const auto& typed_instance = typed(instance);
+        Sequence output;
+        std::vector<int>& tasks = output.get_tasks_modifiable();
+        if (auto* groupMeta = dynamic_cast<GroupMetaSolution*>(&metaSolution)) {
+            derived().extract_group(*groupMeta, typed_instance, scenario_id, tasks, EvaluationScratch::local());
+        }
+        else if (auto* seqMeta = dynamic_cast<SequenceMetaSolution*>(&metaSolution)) {
+            tasks = seqMeta->get_sequence().get_tasks();
+        }
+        // Handling all ListMetaSolution types via their underlying metasolution type (recursive)
+        //we assume the underlying metasolutions have already been scored appropriately ( we make sure of that in evaluate_meta)
+        else if (auto* listMeta = dynamic_cast<ListMetaSolutionBase*>(&metaSolution)) {
+            tasks = listMeta->get_meta_solutions()[select_front(*listMeta, typed_instance, scenario_id)]->front_sequences.view(scenario_id).to_vector();
+        }
+        else {
+            throw std::invalid_argument("Unsupported MetaSolution type in " + derived().name + "::extract_sequence.");
+        }
+        return output;
+    }
+
+    int extract_and_evaluate(MetaSolution& metaSolution, const DataInstance& instance, int scenario_id, Sequence& sequence_out, Schedule* schedule_out = nullptr) const override {
+        int cost = 0;
+        dispatch(metaSolution, instance, [&](auto&& evaluate_one) { cost = evaluate_one(scenario_id, sequence_out); });
+        if (schedule_out) *schedule_out = this->transform_to_schedule(sequence_out, instance, scenario_id);
+        return cost;
+    }
+
+    bool isLexicographicallySmaller(const Sequence& seq1, const Sequence& seq2, const DataInstance& instance, int scenario_id) const override {
+        derived().check_instance(instance);
+        return derived().prefers(seq1.get_tasks(), seq2.get_tasks(), typed(instance), scenario_id);
+    }
+
+    bool prefers_sequence(SequenceView seq1, SequenceView seq2, const DataInstance& instance, int scenario_id) const override {
+        derived().check_instance(instance);
+        return derived().prefers(seq1, seq2, typed(instance), scenario_id);
+    }
+
+protected:
+    void evaluate_positions(MetaSolution& metasol, const DataInstance& instance, int k_begin, int k_end, const std::vector<int>* scenario_order,
+                            std::optional<int> exit_bound, BoundExceedance& exceedance) const override {
+        //extractions may only give up when one exceeding scenario is enough (the others need their score)
+        int abort_above = (exceedance.tolerance == 1) ? exit_bound.value_or(std::numeric_limits<int>::max()) : std::numeric_limits<int>::max();
+        dispatch(metasol, instance, [&](auto&& evaluate_one) {
+            run_positions(metasol, k_begin, k_end, scenario_order, exit_bound, exceedance, evaluate_one);
+        }, abort_above, true);
+    }
+
+    //default : extraction depends on the release date values, no reuse between scenarios (hidden by Derived)
+    template <typename Instance>
+    const int* order_classes(const Instance& instance) const {
+        (void)instance;
+        return nullptr;
+    }
+
+    //default fused extraction : extract, then score (hidden by Derived when it can do both at once). Never gives up
+    template <typename Objective, typename Instance>
+    int extract_group_scored(const GroupMetaSolution& groupMeta, const Instance& instance, int scenario_id, std::vector<int>& sequence, EvaluationScratch& scratch, int abort_above) const {
+        (void)abort_above;
+        derived().extract_group(groupMeta, instance, scenario_id, sequence, scratch);
+        return derived().template score_sequence<Objective>(sequence, instance, scenario_id, scratch);
+    }
+
+    //index of the sub metasolution whose front sequence is preferred by the policy in a scenario (also saved in front_indexes).
+    //the sub metasolutions must already be scored by this policy
+    template <typename Instance>
+    int select_front(ListMetaSolutionBase& listMeta, const Instance& instance, int scenario_id) const {
+        const auto& metaSolutions = listMeta.get_meta_solutions();
+        int minIndex = 0;
+        for (size_t i = 1; i < metaSolutions.size(); ++i) {
+            SequenceHandle candidate = metaSolutions[i]->front_sequences[scenario_id], best = metaSolutions[minIndex]->front_sequences[scenario_id];
+            if (candidate != best && derived().prefers(pool_view(candidate), pool_view(best), instance, scenario_id)) { //same handle : same sequence
+                minIndex = i;
+            }
+        }
+        listMeta.front_indexes[scenario_id] = minIndex;
+        return minIndex;
+    }
+
+private:
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+    static SequenceView pool_view(SequenceHandle handle) { return SequencePool::global().view(handle); }
+
+    //group sequence being extracted, one per thread
+    static std::vector<int>& group_buffer() {
+        thread_local std::vector<int> tasks;
+        return tasks;
     }
 
+    //the instance as the type Derived works on (check_instance must have accepted it)
+    static const auto& typed(const DataInstance& instance) { return static_cast<const typename Derived::Instance&>(instance); }
+
+    //resolves the metasolution type and the objective once, then hands a typed evaluator evaluate_one(scenario_id, out) -> score to body.
+    //out receives the front sequence of the scenario (see put_front) : the front sequences of the metasolution, or a Sequence.
+    //group extractions may stop early (NOT_EVALUATED) once their score is known to exceed abort_above.
+    //with share_orders, scenarios of the same order class (see order_classes) reuse the extraction of the first one evaluated by body
+    template <typename Body>
+    void dispatch(MetaSolution& metaSolution, const DataInstance& instance, Body&& body, int abort_above = std::numeric_limits<int>::max(), bool share_orders = false) const {
+        if(metaSolution.scored_by){throw std::runtime_error("Extracting sequence but metasol is already scored.");}
+        derived().check_instance(instance);
+        with_objective(objective, [&](auto objective_tag) {
+            dispatch_typed<decltype(objective_tag)>(metaSolution, typed(instance), body, abort_above, share_orders);
+        });
+    }
+
+    template <typename Objective, typename Instance, typename Body>
+    void dispatch_typed(MetaSolution& metaSolution, const Instance& instance, Body& body, int abort_above, bool share_orders) const {
+        EvaluationScratch& scratch = EvaluationScratch::local(); //work memory of this thread, reused for all scenarios of the block
+        EvaluationScratch::Frame frame(scratch);
+        const int* classes = share_orders ? derived().order_classes(instance) : nullptr;
+        int* extracted = classes ? scratch.alloc(instance.getS(), -1) : nullptr; //extracted[c] : scenario of class c already evaluated in this block (-1 : none)
+        if (auto* groupMeta = dynamic_cast<GroupMetaSolution*>(&metaSolution)) {
+            std::vector<int>& tasks = group_buffer();
+            FrontSequences class_fronts; //class_fronts[c] : sequence extracted for class c (kept even when out does not keep fronts)
+            if (classes) class_fronts.resize(instance.getS());
+            body([&](int scenario_id, auto& out) {
+                int* source = classes ? &extracted[classes[scenario_id]] : nullptr;
+                if (source && *source >= 0) { //same release order as a scenario already extracted : same sequence, only its objective changes
+                    SequenceHandle front = class_fronts[classes[scenario_id]];
+                    put_front(out, scenario_id, front);
+                    return derived().template score_sequence<Objective>(pool_view(front), instance, scenario_id, scratch);
+                }
+                int cost = derived().template extract_group_scored<Objective>(*groupMeta, instance, scenario_id, tasks, scratch, abort_above);
+                if (cost == MetaSolution::NOT_EVALUATED) return cost; //an aborted extraction leaves an incomplete sequence
+                if (source) {
+                    class_fronts.store(classes[scenario_id], tasks);
+                    put_front(out, scenario_id, class_fronts[classes[scenario_id]]);
+                    *source = scenario_id;
+                }
+                else put_front(out, scenario_id, SequenceView(tasks));
+                return cost;
+            });
+        }
+        else if (auto* seqMeta = dynamic_cast<SequenceMetaSolution*>(&metaSolution)) {
+            const std::vector<int>& tasks = seqMeta->get_sequence().get_tasks();
+            PooledSequence pooled(SequencePool::global().intern(tasks)); //pooled once for the block
+            body([&](int scenario_id, auto& out) {
+                put_front(out, scenario_id, pooled.get());
+                return derived().template score_sequence<Objective>(tasks, instance, scenario_id, scratch);
+            });
+        }
+        else if (auto* listMeta = dynamic_cast<ListMetaSolutionBase*>(&metaSolution)) { //front and score of the preferred sub metasolution (already scored)
+            const auto& metaSolutions = listMeta->get_meta_solutions();
+            body([&](int scenario_id, auto& out) {
+                int index;
+                if (classes && extracted[classes[scenario_id]] >= 0) { //same release order as a scenario already evaluated : same preferred sub metasolution
+                    index = listMeta->front_indexes[extracted[classes[scenario_id]]];
+                    listMeta->front_indexes[scenario_id] = index;
+                }
+                else {
+                    index = select_front(*listMeta, instance, scenario_id);
+                    if (classes) extracted[classes[scenario_id]] = scenario_id;
+                }
+                const MetaSolution& front = *metaSolutions[index];
+                put_front(out, scenario_id, front.front_sequences[scenario_id]);
+                return front.scores[scenario_id];
+            });
+        }
+        else {
+            throw std::invalid_argument("Unsupported MetaSolution type in " + derived().name + ".");
+        }
+    }
 };
 
 
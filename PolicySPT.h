@@ -9,148 +9,23 @@
 #include "Schedule.h"
 #include "Instance.h"
 #include <vector>
-#include <set>
-#include <queue>
-#include <deque>
+#include <algorithm>
+#include <numeric>
 #include <ilcp/cp.h>
 #include <tuple>
 #include <functional>
 
 
 //The Shortest Processing Time policy : schedules the task that has the shortest processing time among ready tasks at each decision points.
-class SPTPolicy : public Policy {
+class SPTPolicy final : public StaticPolicy<SPTPolicy> {
 public:
+    using Instance = SingleMachineInstance; //instance type of the statically dispatched evaluation
     ~SPTPolicy() = default;
 
     std::string name = "spt_policy";
 
-    // How to get a sequence from the meta solutions
-    Sequence extract_sequence(MetaSolution& metaSolution, const DataInstance& instance, int scenario_id) const override{
-        if(metaSolution.scored_by){throw std::runtime_error("Extracting sequence but metasol is already scored.");} //if already scored, why don't we just get the stored result?
- 
-        if (! (instance.type == InstanceType::SINGLE_MACHINE)) {
-            throw std::runtime_error("FIFOPolicy does not support RCPSP instances.");
-        }
-        const SingleMachineInstance& sm_instance = static_cast<const SingleMachineInstance&>(instance); //ensure correct type
-
-
-        Sequence output; 
-        bool set_output = false;
-        // Try to cast to GroupMetaSolution
-        if (auto* groupMeta = dynamic_cast<GroupMetaSolution*>(&metaSolution)) {
-            // Handle GroupMetaSolution Metasolutions
-
-            std::vector<int> sequence(sm_instance.getN()); //stores output
-            int c = 0; // counter for index
-            const auto& releaseDates = sm_instance.releaseDates[scenario_id];
-            const auto& durations = sm_instance.durations;
-            const auto& prec = sm_instance.precedenceConstraints;
-            std::priority_queue<int, std::vector<int>, std::greater<int>> free_nodes; // sorted queue of available (both release and precednece wise) nodes (default comparison by index) sorted by spt (through index of group); 
-            int time  = 0; //tracks time during simulation to see if tasks are ready
-            std::vector<int> incoming_edges_nb; //counts number of edge into each node (prevents the corresponding task to run since prec constraints)
-            std::vector<std::vector<int>> outgoing_edges; //describes who must be after each task (to update them when relevant)
-
-
-            // Iterate over each group of tasks
-            for (auto& group : groupMeta->get_task_groups_modifiable()) { 
-                //creating the second set here due to scope issue, but some overhead is expected.
-                auto releaseDateComparator = [&](int index1, int index2) {
-                    return (releaseDates[group[index1]] < releaseDates[group[index2]]) || ((releaseDates[group[index1]] == releaseDates[group[index2]]) && (group[index1]<group[index2])); //lex if equal (could be unnecessary, but I'm afraid of undefined behavior if weak ordering)
-                };
-                std::set<int, decltype(releaseDateComparator)> prec_free_nodes(releaseDateComparator); // sorted set of prec_available nodes, sorted by release date/lex; 
-
-                // First, sort the tasks by their durations (or lex order if tie) (boolean expression could be slightly more efficient)
-                std::sort(group.begin(), group.end(), [&durations](int t1, int t2) {
-                    //check release dates
-                    if (durations[t1] != durations[t2]) {
-                        return durations[t1] < durations[t2];
-                    }
-                    return t1 < t2; // Lexicographical order as tie-breaker
-                }); //group shouldn't be further modified, as we will use it as a key!
-
-                //precompute a graph-like node structure for toposort (ensures precedence constraints satisfactions)
-                incoming_edges_nb.resize(group.size(), 0);
-                for (auto& vec : outgoing_edges) {vec.clear();} // Clears contents without deallocating
-                outgoing_edges.resize(group.size()); // Ensures correct size without reallocating inner vectors                
-                for (size_t i=0; i<group.size();  i++) { //!!! We use index "0" for example to refer to the 0th task in group vector (it also indicates it has the smallest duration)!
-                    //for each tasks list nodes with an incoming edge
-                    for (size_t j =0; j<group.size(); j++){
-                        if (prec[group[j] * instance.getN() + group[i]]){ //if the task at index j should be before task at index i,
-                            incoming_edges_nb[i]++;
-                        }
-                        if (prec[group[i] * instance.getN() + group[j]]){ 
-                            outgoing_edges[i].push_back(j); 
-                        }                        
-                    }
-                    if (incoming_edges_nb[i]==0){prec_free_nodes.insert(i);}//remember tasks without incoming edge (prec-wise ready) / sorts by release
-                }
-                //find first decision moment : min time when a prec_free task is realeased
-                time = std::max(time,  releaseDates[group[*prec_free_nodes.begin()]]); //jumping to next decision moment if necessary. prec_free_nodes.begin is the smallest release date in the set (sorted)
-                //init done, now looping till group fully treated
-                while (!free_nodes.empty() || !prec_free_nodes.empty()){
-                    //update free_nodes at that time (pre_free nodes that are released)
-                    auto it_begin = prec_free_nodes.begin();
-                    auto it_end = prec_free_nodes.begin();
-                    // Find the iterator to the first element whose release date is greater than time
-                    while (it_end != prec_free_nodes.end() && releaseDates[group[*it_end]] <= time) {
-                        free_nodes.push(*it_end);
-                        ++it_end;
-                    }
-                    // Erase the range [it_begin, it_end)
-                    prec_free_nodes.erase(it_begin, it_end);
-
-                    //find task to schedule and schedule it
-                    int selected_task = free_nodes.top();  // Get the first (smallest) element (there must be one)
-                    free_nodes.pop();    // Remove it from the set
-                    sequence[c++] = group[selected_task];    // Post-increment
-                    for (auto& node : outgoing_edges[selected_task]) {  // Remove edges with this task
-                        incoming_edges_nb[node]--;
-                        if (incoming_edges_nb[node] == 0) {
-                            prec_free_nodes.insert(node);  // Insert node into the set, which keeps it sorted by release date
-                        }
-                    }
-                    time+=durations[group[selected_task]]; //update time
-                    //find new decision time (skip time if no task ready yet). also check it's not the end yet.
-                    if (free_nodes.empty() && !prec_free_nodes.empty()){
-                        time = std::max(time,  releaseDates[group[*prec_free_nodes.begin()]]); //jumping to next decision moment if necessary. prec_free_nodes.begin is the smallest release date in the set (sorted)
-                    }
-                }
-            }
+    bool uses_sequence_kernel() const override { return true; } //sequences are expressed as is, and scheduled with the default ERD schedule
 
-            output = Sequence(std::move(sequence));
-            /*if (!output.check_precedence_constraints(instance)){
-                throw std::runtime_error("bug detected");
-            }*/
-            set_output = true;
-        }
-        else if (auto* SeqMeta = dynamic_cast< SequenceMetaSolution*>(&metaSolution)) {
-            output = Sequence(SeqMeta->get_sequence().get_tasks());
-            set_output = true;
-        }
-        // Handling all ListMetaSolution types via their underlying metasolution type (recursive)
-        //we assume the underlying metasolutions have already been scored appropriately ( we make sure of that in evaluate_meta)
-        else if (auto* listMeta = dynamic_cast< ListMetaSolutionBase*>(&metaSolution)) {
-            const auto& metaSolutions = listMeta->get_meta_solutions();
-            Sequence minSeq = metaSolutions[0]->front_sequences[scenario_id]; // Initialize with the first sequence/metasol
-            listMeta->front_indexes[scenario_id] = 0;
-
-            for (size_t i = 1; i < metaSolutions.size(); ++i) {  // Iterate from second element to find smallest(lexicographically)
-                auto& seq = metaSolutions[i]->front_sequences[scenario_id];
-                if (isLexicographicallySmaller(seq, minSeq, instance, scenario_id)) {
-                    minSeq = seq;
-                    listMeta->front_indexes[scenario_id] = i;//update index of metasol used in that scenario
-                }
-            }
-            output = std::move(minSeq); 
-            set_output = true;
-        }
-        // Add other MetaSolution type checks here if necessary
-        if (!set_output){
-            throw std::invalid_argument("Unsupported MetaSolution type in FIFOPolicy::extract_sequence.");
-        }
-        return output;
-    }
-    
     int extract_sub_metasolution_index(const MetaSolution& metaSolution, const DataInstance& instance, int scenario_id) const override{
         //assert list solution
         const ListMetaSolutionBase* listMetaSolution = dynamic_cast<const ListMetaSolutionBase*>(&metaSolution);
@@ -165,45 +40,153 @@ public:
         (void)instance; //legacy, in theory requires instance 
     }
 
-    //compares two sequences to find the preffered one by SPT in a given scenario 
-    bool isLexicographicallySmaller(const Sequence& seq1, const Sequence& seq2, const DataInstance& instance, int scenario_id) const {
+private:
+    friend class StaticPolicy<SPTPolicy>; //statically dispatched evaluation (see Policy.h)
+
+    void check_instance(const DataInstance& instance) const {
         if (! (instance.type == InstanceType::SINGLE_MACHINE)) {
-            throw std::runtime_error("FIFOPolicy does not support RCPSP instances.");
+            throw std::runtime_error("SPTPolicy does not support RCPSP instances.");
         }
-        const SingleMachineInstance& sm_instance = static_cast<const SingleMachineInstance&>(instance); //ensure correct type
+    }
 
-        const auto& releaseDates = sm_instance.releaseDates[scenario_id]; 
+    void extract_group(const GroupMetaSolution& groupMeta, const Instance& instance, int scenario_id, std::vector<int>& sequence, EvaluationScratch& scratch) const {
+        extract_group_scored<NoObjective>(groupMeta, instance, scenario_id, sequence, scratch, std::numeric_limits<int>::max());
+    }
+
+    //objective of a sequence : objective of its ERD schedule
+    template <typename Objective>
+    int score_sequence(SequenceView tasks, const Instance& instance, int scenario_id, EvaluationScratch&) const {
+        return sequence_objective<Objective>(tasks, instance, scenario_id);
+    }
+
+    //compares two sequences to find the preffered one by SPT in a given scenario 
+    bool prefers(SequenceView tasks1, SequenceView tasks2, const Instance& sm_instance, int scenario_id) const {
+        const int* releaseDates = sm_instance.releaseDates.row(scenario_id);
         const auto& durations = sm_instance.durations; 
-        const auto& tasks1 = seq1.get_tasks(); // Cache tasks of seq1
-        const auto& tasks2 = seq2.get_tasks(); // Cache tasks of seq2
-        size_t size = tasks1.size(); // Assuming both sequences have the same size
+        int size = tasks1.size(); // Assuming both sequences have the same size
+
+        // Find dissimilarity : the common prefix only matters through the time at which it ends
+        int i = first_mismatch(tasks1.data(), tasks2.data(), size);
+        if (i == size) return false; // sequences are equal. So not strictly smaller
         int time = 0; // tracks time 
+        for (int k = 0; k < i; ++k) time = std::max(time, releaseDates[tasks1[k]]) + durations[tasks1[k]];
+
+        int taskA = tasks1[i];
+        int taskB = tasks2[i];
+        //check if a task is ready before the other and it matters (not both ready at the current time)
+        if ((releaseDates[taskA] != releaseDates[taskB]) && ((releaseDates[taskB]>time) || (releaseDates[taskA]>time))){
+            // Earlier release date wins
+            return releaseDates[taskA] < releaseDates[taskB];
+        }
+        //They have the same effective release date, so if they have different durations, we prefer smalller tasks
+        if (durations[taskA] != durations[taskB]) {
+            // smaller durations wins
+            return durations[taskA] < durations[taskB];
+        }
+        // If effective release dates are equal, and durations are equal, compare task indices lexicographically
+        return taskA < taskB;
+    }
 
-        // Compare task order in sequences (to find dissimilarity)
-        for (size_t i = 0; i < size; ++i) { 
-            int taskA = tasks1[i];
-            int taskB = tasks2[i];
+    //SPT sequence of a group metasolution in a scenario, written in sequence. Returns the objective of its ERD schedule (computed on the fly),
+    //or NOT_EVALUATED as soon as a lower bound of the objective (see Objective.h) exceeds abort_above.
+    //Groups are simulated with two rank-keyed bitmask queues : tasks whose predecessors are done wait by release rank (pending) until released,
+    //then are picked by duration rank (ready). Duration ranks are cached in the group graph, release ranks come from the presorted scenario order.
+    template <typename Objective>
+    int extract_group_scored(const GroupMetaSolution& groupMeta, const Instance& sm_instance, int scenario_id, std::vector<int>& sequence, EvaluationScratch& scratch, int abort_above) const {
+        const int N = sm_instance.getN();
+        sequence.resize(N); //stores output
+        int c = 0; // counter for index
+        const int* releaseDates = sm_instance.releaseDates.row(scenario_id);
+        const int* durations = sm_instance.durations.data();
+        const ObjectiveData data = ObjectiveData::of(sm_instance);
+        const GroupPrecedenceGraph& graph = groupMeta.get_precedence_graph(sm_instance); //precedences and duration ranks inside each group (cached in the metasolution)
+        const auto& taskGroups = groupMeta.get_task_groups();
+        EvaluationScratch::Frame frame(scratch);
+
+        // release ranks of this scenario inside each group, by a single pass over the scenario release order
+        const int nb_nodes = graph.node_begin.back();
+        int* release_order = scratch.alloc(nb_nodes); //release_order[node_begin[k] + p] : position in group k of its p-th task by (release date, id)
+        int* release_position = scratch.alloc(nb_nodes); //inverse
+        int* next = scratch.alloc(taskGroups.size());
+        std::copy(graph.node_begin.begin(), graph.node_begin.end() - 1, next);
+        const int* scenario_order = sm_instance.get_release_order(scenario_id);
+        for (int p = 0; p < N; p++) {
+            int task = scenario_order[p];
+            int k = graph.group_of[task];
+            if (k < 0) continue;
+            int base = graph.node_begin[k];
+            release_order[next[k]] = graph.position_of[task];
+            release_position[base + graph.position_of[task]] = next[k] - base;
+            next[k]++;
+        }
 
-            //check if a task is ready before the other and it matters (not both ready at the current time)
-            if ((releaseDates[taskA] != releaseDates[taskB]) && ((releaseDates[taskB]>time) || (releaseDates[taskA]>time))){
-                // Earlier release date wins
-                return releaseDates[taskA] < releaseDates[taskB];
-            }
-            //They have the same effective release date, so if they have different durations, we prefer smalller tasks
-            if (durations[taskA] != durations[taskB]) {
-                // smaller durations wins
-                return durations[taskA] < durations[taskB];
+        int time  = 0; //tracks time during simulation to see if tasks are ready
+        int currentTime = 0; //ERD schedule of the sequence, built as tasks are appended
+        int value = 0; //objective so far
+        for (size_t k = 0; k < taskGroups.size(); k++) {
+            EvaluationScratch::Frame group_frame(scratch); //queues of the group, released at the end of the iteration
+            const auto& taskGroup = taskGroups[k];
+            const int g = taskGroup.size();
+            const int base = graph.node_begin[k];
+            const int nb_words = (g + 63) / 64;
+            int* remaining_preds = scratch.alloc(g); //counts predecessors not yet scheduled (prevents the corresponding task to run since prec constraints)
+            std::copy(graph.pred_count.begin() + base, graph.pred_count.begin() + base + g, remaining_preds);
+            uint64_t* pending = scratch.alloc_words(nb_words); //bit p : task of release rank p is prec-free but not yet considered released
+            uint64_t* ready = scratch.alloc_words(nb_words); //bit p : task of duration rank p is available (both release and precedence wise)
+            int pending_word = 0, ready_word = 0; //no bit set before these words
+            int nb_pending = 0, nb_ready = 0;
+            auto push_pending = [&](int i) {
+                int q = release_position[base + i];
+                pending[q >> 6] |= uint64_t(1) << (q & 63);
+                pending_word = std::min(pending_word, q >> 6);
+                nb_pending++;
+            };
+            auto first_pending = [&]() { //position in the group of the pending task with the smallest release date
+                while (pending[pending_word] == 0) pending_word++;
+                return release_order[base + (pending_word << 6) + __builtin_ctzll(pending[pending_word])];
+            };
+            for (int i = 0; i < g; i++) {
+                if (remaining_preds[i] == 0) push_pending(i); //remember tasks without incoming edge (prec-wise ready)
             }
+            if (nb_pending == 0) continue; //empty group
+            //find first decision moment : min time when a prec_free task is realeased
+            time = std::max(time, releaseDates[taskGroup[first_pending()]]); //jumping to next decision moment if necessary
+            //init done, now looping till group fully treated
+            while (nb_ready > 0 || nb_pending > 0) {
+                //move released pending tasks to the ready queue
+                while (nb_pending > 0) {
+                    int i = first_pending();
+                    if (releaseDates[taskGroup[i]] > time) break;
+                    pending[pending_word] &= pending[pending_word] - 1; //remove lowest bit
+                    nb_pending--;
+                    int q = graph.duration_position[base + i];
+                    ready[q >> 6] |= uint64_t(1) << (q & 63);
+                    ready_word = std::min(ready_word, q >> 6);
+                    nb_ready++;
+                }
 
-            // If effective release dates are equal, and durations are equal, compare task indices lexicographically if they're different
-            if (taskA != taskB) {
-                return taskA < taskB;
+                //find task to schedule and schedule it : smallest duration rank (there must be one)
+                while (ready[ready_word] == 0) ready_word++;
+                int selected = graph.duration_order[base + (ready_word << 6) + __builtin_ctzll(ready[ready_word])];
+                ready[ready_word] &= ready[ready_word] - 1;
+                nb_ready--;
+                int task = taskGroup[selected];
+                sequence[c++] = task;
+                currentTime = std::max(currentTime, releaseDates[task]) + durations[task];
+                value = Objective::add(value, task, currentTime, data);
+                if (Objective::lower_bound(value, currentTime, nb_nodes - c, graph.spt_completion_bound.data()) > abort_above) return MetaSolution::NOT_EVALUATED;
+                for (int e = graph.succ_begin[base + selected]; e < graph.succ_begin[base + selected + 1]; e++) {  // Remove edges with this task
+                    if (--remaining_preds[graph.succ[e]] == 0) push_pending(graph.succ[e]);
+                }
+                time+=durations[task]; //update time
+                //find new decision time (skip time if no task ready yet). also check it's not the end yet.
+                if (nb_ready == 0 && nb_pending > 0){
+                    time = std::max(time, releaseDates[taskGroup[first_pending()]]); //jumping to next decision moment if necessary
+                }
             }
-            time = std::max(time, releaseDates[taskA]) + durations[taskA]; //same task, tracking time
         }
 
-        // At this point, sequences should be equal. So not strictly smaller
-        return false;
+        return value;
     }
     };
 
@@ -66,8 +66,9 @@ void generateRCPSPScenarios(const fs::path& inputPath, const fs::path& outputDir
     // std::cout << "Offsets: " << vec_to_string(offsets) << std::endl;
 
     // ... [Scenario generation logic] ...
-    std::vector<std::vector<int>> scenarioReleaseDates(numScenarios, std::vector<int>(base.N));
+    ScenarioMatrix scenarioReleaseDates(numScenarios, base.N);
     for (int s = 0; s < numScenarios; ++s) {
+        int* releaseDates = scenarioReleaseDates.row(s);
         // Selection of indices to be "flipped" (the budget)
         std::vector<int> indices(base.N-2); // Exclude first and last task
         std::iota(indices.begin(), indices.end(), 1);
@@ -75,14 +76,14 @@ void generateRCPSPScenarios(const fs::path& inputPath, const fs::path& outputDir
 
         // Initial pass: Set all jobs to nominal base values
         for (int i = 0; i < base.N; ++i) {
-            scenarioReleaseDates[s][i] = nominalReleaseDates[i];
+            releaseDates[i] = nominalReleaseDates[i];
         }
 
         // Apply the offset to exactly 'gamma' random jobs (or all if gamma > N-2)
         int effective_gamma = std::min(gamma, base.N-2);
         for (int k = 0; k < effective_gamma; ++k) {
             int job_idx = indices[k];
-            scenarioReleaseDates[s][job_idx] += offsets[job_idx];
+            releaseDates[job_idx] += offsets[job_idx];
         }
     }
 
@@ -0,0 +1,219 @@
+#ifndef SCENARIO_MATRIX_H
+#define SCENARIO_MATRIX_H
+
+#include <vector>
+#include <cstdlib>
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+
+//allocator returning 64 bytes aligned memory (one cache line, also the width of an AVX-512 register)
+template <typename T>
+struct AlignedAllocator {
+    typedef T value_type;
+    static constexpr size_t alignment = 64;
+
+    AlignedAllocator() noexcept {}
+    template <typename U> AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        size_t bytes = (n * sizeof(T) + alignment - 1) / alignment * alignment; //aligned_alloc requires a multiple of the alignment
+        void* p = std::aligned_alloc(alignment, bytes == 0 ? alignment : bytes);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) noexcept { std::free(p); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; }
+};
+
+// Dense rows x cols matrix of ints stored in a single aligned buffer (used for scenario data : one row per scenario, one column per task).
+// Rows are padded to a multiple of 16 values so every row starts on a 64 bytes boundary.
+// matrix[r][c] and matrix.row(r)[c] both work (rows are plain pointers).
+// A task-major (transposed) copy is built on demand for the cross-scenario kernels : transposed()[c * transposed_stride() + r].
+// The sorted order of each row is also built on demand : row_order(r) lists the columns of row r by increasing value (column index if tie),
+// and row_rank(r)[c] is the position of column c in that order. Rows with the same order share an order class (row_order_classes()[r] : first such row).
+class ScenarioMatrix {
+public:
+    static constexpr int PADDING = 16;
+
+    ScenarioMatrix() {}
+    ScenarioMatrix(int rows, int cols, int value = 0) { assign(rows, cols, value); }
+
+    ScenarioMatrix(const ScenarioMatrix& other) //the transposed copy and row orders are not copied, they are rebuilt on demand
+        : values(other.values), nb_rows(other.nb_rows), nb_cols(other.nb_cols), row_stride(other.row_stride) {}
+
+    ScenarioMatrix& operator=(const ScenarioMatrix& other) {
+        if (this != &other) {
+            values = other.values;
+            nb_rows = other.nb_rows;
+            nb_cols = other.nb_cols;
+            row_stride = other.row_stride;
+            invalidate_derived();
+        }
+        return *this;
+    }
+
+    //resizes the matrix and fills it with value
+    void assign(int rows, int cols, int value = 0) {
+        nb_rows = rows;
+        nb_cols = cols;
+        row_stride = (cols + PADDING - 1) / PADDING * PADDING;
+        values.assign(static_cast<size_t>(rows) * row_stride, value);
+        invalidate_derived();
+    }
+
+    //this matrix becomes the selected rows of other (in the given order)
+    void extract_rows(const ScenarioMatrix& other, const std::vector<int>& indices) {
+        nb_rows = indices.size();
+        nb_cols = other.nb_cols;
+        row_stride = other.row_stride;
+        values.resize(static_cast<size_t>(nb_rows) * row_stride);
+        for (int r = 0; r < nb_rows; ++r) {
+            std::copy(other.row(indices[r]), other.row(indices[r]) + row_stride, row(r));
+        }
+        invalidate_derived();
+    }
+
+    //adds a row at the end (values : cols values)
+    void append_row(const std::vector<int>& row_values) {
+        values.resize(static_cast<size_t>(nb_rows + 1) * row_stride, 0);
+        std::copy(row_values.begin(), row_values.begin() + std::min<size_t>(row_values.size(), nb_cols), values.data() + static_cast<size_t>(nb_rows) * row_stride);
+        nb_rows++;
+        invalidate_derived();
+    }
+
+    //removes rows (indices sorted in increasing order), the others keep their order
+    void remove_rows(const std::vector<int>& sorted_indices) {
+        int kept = 0;
+        size_t next = 0;
+        for (int r = 0; r < nb_rows; ++r) {
+            if (next < sorted_indices.size() && sorted_indices[next] == r) { next++; continue; }
+            if (kept != r) std::copy(values.data() + static_cast<size_t>(r) * row_stride, values.data() + static_cast<size_t>(r + 1) * row_stride,
+                                     values.data() + static_cast<size_t>(kept) * row_stride);
+            kept++;
+        }
+        nb_rows = kept;
+        values.resize(static_cast<size_t>(nb_rows) * row_stride);
+        invalidate_derived();
+    }
+
+    int rows() const { return nb_rows; }
+    int cols() const { return nb_cols; }
+    int stride() const { return row_stride; }
+
+    const int* row(int r) const { return values.data() + static_cast<size_t>(r) * row_stride; }
+    int* row(int r) { //writing access : drops the transposed copy and row orders if they were built
+        if (transposed_built.load(std::memory_order_relaxed) || order_built.load(std::memory_order_relaxed)) invalidate_derived();
+        return values.data() + static_cast<size_t>(r) * row_stride;
+    }
+    const int* operator[](int r) const { return row(r); }
+    int* operator[](int r) { return row(r); }
+
+    //task-major copy, built once on first call (thread safe)
+    const int* transposed() const {
+        if (!transposed_built.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(derived_mutex);
+            if (!transposed_built.load(std::memory_order_relaxed)) {
+                transposed_row_stride = (nb_rows + PADDING - 1) / PADDING * PADDING;
+                transposed_values.assign(static_cast<size_t>(nb_cols) * transposed_row_stride, 0);
+                for (int r = 0; r < nb_rows; ++r) {
+                    const int* source = row(r);
+                    for (int c = 0; c < nb_cols; ++c) {
+                        transposed_values[static_cast<size_t>(c) * transposed_row_stride + r] = source[c];
+                    }
+                }
+                transposed_built.store(true, std::memory_order_release);
+            }
+        }
+        return transposed_values.data();
+    }
+    int transposed_stride() const { transposed(); return transposed_row_stride; }
+
+    //columns of row r sorted by (value, column), built for all rows (with the ranks) on first call (thread safe)
+    const int* row_order(int r) const {
+        if (!order_built.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(derived_mutex);
+            if (!order_built.load(std::memory_order_relaxed)) {
+                order_values.resize(values.size());
+                rank_values.resize(values.size());
+                for (int i = 0; i < nb_rows; ++i) {
+                    const int* source = row(i);
+                    int* order = order_values.data() + static_cast<size_t>(i) * row_stride;
+                    for (int c = 0; c < nb_cols; ++c) order[c] = c;
+                    std::sort(order, order + nb_cols, [source](int c1, int c2) {
+                        return source[c1] < source[c2] || (source[c1] == source[c2] && c1 < c2);
+                    });
+                    int* rank = rank_values.data() + static_cast<size_t>(i) * row_stride;
+                    for (int p = 0; p < nb_cols; ++p) rank[order[p]] = p;
+                }
+                build_order_classes();
+                order_built.store(true, std::memory_order_release);
+            }
+        }
+        return order_values.data() + static_cast<size_t>(r) * row_stride;
+    }
+
+    //position of each column of row r in row_order(r)
+    const int* row_rank(int r) const {
+        row_order(r);
+        return rank_values.data() + static_cast<size_t>(r) * row_stride;
+    }
+
+    //order class of each row : index of the first row sorted in the same order (the row itself if none before).
+    //Anything computed from the order of a row only (not from its values) is the same for all the rows of a class
+    const int* row_order_classes() const {
+        row_order(0);
+        return order_class_values.data();
+    }
+
+private:
+    std::vector<int, AlignedAllocator<int>> values;
+    int nb_rows = 0;
+    int nb_cols = 0;
+    int row_stride = 0;
+
+    mutable std::vector<int, AlignedAllocator<int>> transposed_values;
+    mutable int transposed_row_stride = 0;
+    mutable std::atomic<bool> transposed_built{false};
+    mutable std::vector<int, AlignedAllocator<int>> order_values; //same layout as values
+    mutable std::vector<int, AlignedAllocator<int>> rank_values;
+    mutable std::vector<int> order_class_values; //one per row
+    mutable std::atomic<bool> order_built{false};
+    mutable std::mutex derived_mutex; //guards the construction of the transposed copy and of the row orders
+
+    void invalidate_derived() {
+        std::lock_guard<std::mutex> lock(derived_mutex);
+        transposed_built.store(false);
+        transposed_values.clear();
+        order_built.store(false);
+        order_values.clear();
+        rank_values.clear();
+        order_class_values.clear();
+    }
+
+    //groups rows by order (hash of the order, then exact comparison). Called with derived_mutex held, once the orders are built
+    void build_order_classes() const {
+        order_class_values.resize(nb_rows);
+        std::unordered_multimap<uint64_t, int> rows_by_hash;
+        rows_by_hash.reserve(nb_rows);
+        for (int i = 0; i < nb_rows; ++i) {
+            const int* order = order_values.data() + static_cast<size_t>(i) * row_stride;
+            uint64_t h = 1469598103934665603ULL;
+            for (int c = 0; c < nb_cols; ++c) h = (h ^ static_cast<uint64_t>(order[c])) * 1099511628211ULL;
+            order_class_values[i] = i;
+            auto range = rows_by_hash.equal_range(h);
+            for (auto it = range.first; it != range.second; ++it) {
+                const int* other = order_values.data() + static_cast<size_t>(it->second) * row_stride;
+                if (std::equal(order, order + nb_cols, other)) { order_class_values[i] = it->second; break; }
+            }
+            if (order_class_values[i] == i) rows_by_hash.emplace(h, i);
+        }
+    }
+};
+
+#endif // SCENARIO_MATRIX_H
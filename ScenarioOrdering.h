@@ -0,0 +1,59 @@
+#ifndef SCENARIO_ORDERING_H
+#define SCENARIO_ORDERING_H
+
+#include <vector>
+#include <numeric>
+#include <utility>
+
+// Exploration order of the scenarios of an instance for bounded evaluations (Policy::evaluate_meta_bounded) : scenarios that most often
+// exceeded the bound recently come first, so that candidates that will be rejected are rejected after one or two scenarios.
+// Each instance keeps its own (DataInstance::get_scenario_ordering), shared by every algorithm and every run on that instance.
+// Statistics are a decayed hit count : each trigger counts 1/decay times more than the previous one.
+// Not thread safe : meant to be updated by the (sequential) algorithms, between evaluations.
+class ScenarioOrdering {
+public:
+    static constexpr double DECAY = 0.95;
+
+    ScenarioOrdering() {}
+    explicit ScenarioOrdering(int S) { reset(S); }
+
+    //forgets the statistics, scenarios in their natural order
+    void reset(int S) {
+        scenario_order.resize(S);
+        std::iota(scenario_order.begin(), scenario_order.end(), 0);
+        position = scenario_order;
+        hits.assign(S, 0.0);
+        increment = 1.0;
+    }
+
+    int size() const { return scenario_order.size(); }
+
+    //order()[0] : scenario to try first
+    const std::vector<int>& order() const { return scenario_order; }
+
+    //scenario made a bounded evaluation stop : it moves up past the scenarios with fewer (decayed) hits
+    void record_trigger(int scenario) {
+        hits[scenario] += increment;
+        increment /= DECAY; //older hits weigh less than the new ones
+        if (increment > 1e100) { //renormalize before overflow
+            for (double& h : hits) h /= increment;
+            increment = 1.0;
+        }
+        int p = position[scenario];
+        while (p > 0 && hits[scenario_order[p - 1]] < hits[scenario]) { //scores only grow : bubble up
+            int before = scenario_order[p - 1];
+            std::swap(scenario_order[p], scenario_order[p - 1]);
+            position[before] = p;
+            p--;
+        }
+        position[scenario] = p;
+    }
+
+private:
+    std::vector<int> scenario_order;
+    std::vector<int> position; //position[s] : index of scenario s in scenario_order
+    std::vector<double> hits; //decayed hit count, scaled by increment
+    double increment = 1.0;
+};
+
+#endif // SCENARIO_ORDERING_H
@@ -10,38 +10,14 @@
 
 Schedule::Schedule(std::vector<int> startTimesArray) : startTimes(startTimesArray) {}
 
-// Maybe there should be an input for evaluation type gamma. 
-// For now implemented type is sumci.
+// objective of the schedule (sumci by default, see Objective.h).
 // note that feasibility is not checked.
-int Schedule::evaluate(const DataInstance& instance) {
+int Schedule::evaluate(const DataInstance& instance, ObjectiveKind objective) {
     // A schedule is evaluated for an instance (scenario is irrelevant, feasibility isn't checked)
-    // feasibility (precedences, overlap, release dates) is assumed
-    if (instance.type == InstanceType::SINGLE_MACHINE) {
-        const SingleMachineInstance& sm_instance = static_cast<const SingleMachineInstance&>(instance); //static cast (fast)
-        // for each task, add up end time 
-        int sumci = 0;
-        for (int i = 0; i < sm_instance.N; ++i) {
-            //int lateness = startTimes[i]+instance.durations[i]-instance.dueDates[i];
-            sumci +=  startTimes[i]+sm_instance.durations[i]; //adding end time of task       
-        }
-        return sumci;
-    }
-    else if (instance.type == InstanceType::RCPSP)
-    {
-        const RCPSPInstance& rcpsp_instance = static_cast<const RCPSPInstance&>(instance);
-        // for each task, add up end time 
-        int sumci = 0;
-        for (int i = 0; i < rcpsp_instance.N; ++i) {
-            //int lateness = startTimes[i]+instance.durations[i]-instance.dueDates[i];
-            //int makespan = std::max(makespan, startTimes[i]+instance.durations[i]);
-            sumci +=  startTimes[i]+rcpsp_instance.durations[i]; //adding end time of task       
-        }
-        return sumci;
-    }
-    
-    else {
-        throw std::runtime_error("Schedule evaluation not implemented for this instance type.");
-    }
+    // feasibility (precedences, overlap, release dates) is assumed. Only durations, due dates and weights are used : same for all instance types
+    return with_objective(objective, [&](auto objective_tag) {
+        return objective_of_start_times<decltype(objective_tag)>(startTimes.data(), instance.getN(), ObjectiveData::of(instance));
+    });
 }
 
 void Schedule::print() {
@@ -2,13 +2,14 @@
 #define SCHEDULE_H
 
 #include "Instance.h"  // Include other necessary headers
+#include "Objective.h"
 
 class Schedule {
 public:
     std::vector<int> startTimes;
 
     explicit Schedule(std::vector<int> startTimesArray);
-    int evaluate(const DataInstance& instance);
+    int evaluate(const DataInstance& instance, ObjectiveKind objective = ObjectiveKind::SUM_COMPLETION);
     void print();
 };
 
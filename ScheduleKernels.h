@@ -0,0 +1,286 @@
+#ifndef SCHEDULE_KERNELS_H
+#define SCHEDULE_KERNELS_H
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SCHEDULE_KERNELS_X86 //AVX2/AVX-512 versions are compiled with target attributes and picked at runtime (no -march needed)
+#endif
+
+// Vectorized schedule kernels for single machine instances.
+// The ERD schedule of a sequence is C_k = max(C_{k-1}, r_k) + p_k. When the sequence is the same in every scenario (SequenceMetaSolution),
+// only the release dates change, so the recurrence is run for 16 (AVX-512) or 8 (AVX2) scenarios at once, one scenario per lane.
+// Release dates are read task-major : releaseByTask[task * stride + s] (see SingleMachineInstance::get_release_dates_by_task)
+// The sequence_sumci kernels write the sum of completion times (sumci) of scenarios [s_begin, s_end) in out[s_begin..s_end).
+
+//portable version (blocks of scenarios so the compiler can vectorize), also handles the last scenarios of the vector versions
+inline void sequence_sumci_kernel_scalar(const int* tasks, int n, const int* durations, const int* releaseByTask, int stride,
+                                         int s_begin, int s_end, int* out) {
+    constexpr int W = 8;
+    int s = s_begin;
+    for (; s + W <= s_end; s += W) {
+        int current[W] = {0};
+        int sum[W] = {0};
+        for (int k = 0; k < n; k++) {
+            const int* r = releaseByTask + static_cast<size_t>(tasks[k]) * stride + s;
+            int p = durations[tasks[k]];
+            for (int l = 0; l < W; l++) {
+                current[l] = std::max(current[l], r[l]) + p;
+                sum[l] += current[l];
+            }
+        }
+        for (int l = 0; l < W; l++) out[s + l] = sum[l];
+    }
+    for (; s < s_end; s++) {
+        int current = 0;
+        int sum = 0;
+        for (int k = 0; k < n; k++) {
+            current = std::max(current, releaseByTask[static_cast<size_t>(tasks[k]) * stride + s]) + durations[tasks[k]];
+            sum += current;
+        }
+        out[s] = sum;
+    }
+}
+
+#ifdef SCHEDULE_KERNELS_X86
+__attribute__((target("avx2")))
+inline void sequence_sumci_kernel_avx2(const int* tasks, int n, const int* durations, const int* releaseByTask, int stride,
+                                       int s_begin, int s_end, int* out) {
+    int s = s_begin;
+    for (; s + 8 <= s_end; s += 8) {
+        __m256i current = _mm256_setzero_si256();
+        __m256i sum = _mm256_setzero_si256();
+        for (int k = 0; k < n; k++) {
+            __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(releaseByTask + static_cast<size_t>(tasks[k]) * stride + s));
+            current = _mm256_add_epi32(_mm256_max_epi32(current, r), _mm256_set1_epi32(durations[tasks[k]]));
+            sum = _mm256_add_epi32(sum, current);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + s), sum);
+    }
+    sequence_sumci_kernel_scalar(tasks, n, durations, releaseByTask, stride, s, s_end, out);
+}
+
+__attribute__((target("avx512f")))
+inline void sequence_sumci_kernel_avx512(const int* tasks, int n, const int* durations, const int* releaseByTask, int stride,
+                                         int s_begin, int s_end, int* out) {
+    int s = s_begin;
+    for (; s + 16 <= s_end; s += 16) {
+        __m512i current = _mm512_setzero_si512();
+        __m512i sum = _mm512_setzero_si512();
+        for (int k = 0; k < n; k++) {
+            __m512i r = _mm512_loadu_si512(releaseByTask + static_cast<size_t>(tasks[k]) * stride + s);
+            current = _mm512_add_epi32(_mm512_max_epi32(current, r), _mm512_set1_epi32(durations[tasks[k]]));
+            sum = _mm512_add_epi32(sum, current);
+        }
+        _mm512_storeu_si512(out + s, sum);
+    }
+    sequence_sumci_kernel_avx2(tasks, n, durations, releaseByTask, stride, s, s_end, out);
+}
+#endif
+
+//entry point : picks the widest instruction set supported by the cpu
+inline void sequence_sumci_kernel(const int* tasks, int n, const int* durations, const int* releaseByTask, int stride,
+                                  int s_begin, int s_end, int* out) {
+#ifdef SCHEDULE_KERNELS_X86
+    static const int level = __builtin_cpu_supports("avx512f") ? 2 : (__builtin_cpu_supports("avx2") ? 1 : 0);
+    if (level == 2) return sequence_sumci_kernel_avx512(tasks, n, durations, releaseByTask, stride, s_begin, s_end, out);
+    if (level == 1) return sequence_sumci_kernel_avx2(tasks, n, durations, releaseByTask, stride, s_begin, s_end, out);
+#endif
+    sequence_sumci_kernel_scalar(tasks, n, durations, releaseByTask, stride, s_begin, s_end, out);
+}
+
+// Max-plus scan kernels, for one scenario and very long sequences (N in the thousands and more, few scenarios) : the recurrence is parallel over
+// the tasks instead of the scenarios. Task k is the function t -> max(t, r_k) + p_k = max(t + a_k, b_k) with a_k = p_k, b_k = r_k + p_k, and
+// (a1, b1) then (a2, b2) is (a1 + a2, max(b1 + a2, b2)) : completion times are a prefix scan of these pairs (associative).
+// A sequence is cut in blocks of tasks, each handled on its own (e.g. by different threads) in two passes :
+//   max_plus_scan_block : completions[k] for the tasks of the block as if it started at time 0 (release dates are >= 0, so it is the scan of the b_k)
+//   max_plus_block_sumci : sum of the completion times of the block when it starts at start. prefix[k] : durations of tasks[0..k] summed, so
+//       the completion of task k is max(start + prefix[k] - prefix[k_begin - 1], completions[k]). The start of the next block is the completion of its last task.
+// Release dates are read scenario-major (releaseDates : row of the scenario), the tasks of the block are gathered. Sums wrap like the other kernels.
+inline void max_plus_scan_block_scalar(const int* tasks, int k_begin, int k_end, const int* durations, const int* releaseDates, int* completions) {
+    int current = 0;
+    for (int k = k_begin; k < k_end; k++) {
+        current = std::max(current, releaseDates[tasks[k]]) + durations[tasks[k]];
+        completions[k] = current;
+    }
+}
+
+inline int max_plus_block_sumci_scalar(const int* prefix, const int* completions, int k_begin, int k_end, int start) {
+    const int offset = start - (k_begin > 0 ? prefix[k_begin - 1] : 0);
+    unsigned sum = 0;
+    for (int k = k_begin; k < k_end; k++) sum += static_cast<unsigned>(std::max(offset + prefix[k], completions[k]));
+    return static_cast<int>(sum);
+}
+
+#ifdef SCHEDULE_KERNELS_X86
+//one step of the in-register scan : each lane combined with the lane d places before it (identity for the first d lanes)
+__attribute__((target("avx2")))
+inline void max_plus_scan_step_avx2(__m256i& a, __m256i& b, __m256i shift, int lanes_mask) {
+    const __m256i none = _mm256_set1_epi32(-(1 << 29)); //b of the identity (below any time, no overflow once durations are added)
+    __m256i a_prev = _mm256_permutevar8x32_epi32(a, shift);
+    __m256i b_prev = _mm256_permutevar8x32_epi32(b, shift);
+    __m256i keep = _mm256_set_epi32(lanes_mask & 128 ? -1 : 0, lanes_mask & 64 ? -1 : 0, lanes_mask & 32 ? -1 : 0, lanes_mask & 16 ? -1 : 0,
+                                    lanes_mask & 8 ? -1 : 0, lanes_mask & 4 ? -1 : 0, lanes_mask & 2 ? -1 : 0, lanes_mask & 1 ? -1 : 0);
+    a_prev = _mm256_blendv_epi8(a_prev, _mm256_setzero_si256(), keep);
+    b_prev = _mm256_blendv_epi8(b_prev, none, keep);
+    b = _mm256_max_epi32(_mm256_add_epi32(b_prev, a), b);
+    a = _mm256_add_epi32(a_prev, a);
+}
+
+__attribute__((target("avx2")))
+inline void max_plus_scan_block_avx2(const int* tasks, int k_begin, int k_end, const int* durations, const int* releaseDates, int* completions) {
+    const __m256i shift1 = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+    const __m256i shift2 = _mm256_setr_epi32(0, 0, 0, 1, 2, 3, 4, 5);
+    const __m256i shift4 = _mm256_setr_epi32(0, 0, 0, 0, 0, 1, 2, 3);
+    const __m256i last = _mm256_set1_epi32(7);
+    __m256i carry_a = _mm256_setzero_si256(); //scan of the tasks before, in every lane
+    __m256i carry_b = _mm256_setzero_si256(); //the block starts at time 0
+    int k = k_begin;
+    for (; k + 8 <= k_end; k += 8) {
+        __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tasks + k));
+        __m256i a = _mm256_i32gather_epi32(durations, index, 4);
+        __m256i b = _mm256_add_epi32(_mm256_i32gather_epi32(releaseDates, index, 4), a);
+        max_plus_scan_step_avx2(a, b, shift1, 0x01);
+        max_plus_scan_step_avx2(a, b, shift2, 0x03);
+        max_plus_scan_step_avx2(a, b, shift4, 0x0F);
+        b = _mm256_max_epi32(_mm256_add_epi32(carry_b, a), b);
+        a = _mm256_add_epi32(carry_a, a);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(completions + k), b);
+        carry_a = _mm256_permutevar8x32_epi32(a, last);
+        carry_b = _mm256_permutevar8x32_epi32(b, last);
+    }
+    int current = (k > k_begin) ? completions[k - 1] : 0;
+    for (; k < k_end; k++) {
+        current = std::max(current, releaseDates[tasks[k]]) + durations[tasks[k]];
+        completions[k] = current;
+    }
+}
+
+__attribute__((target("avx2")))
+inline int max_plus_block_sumci_avx2(const int* prefix, const int* completions, int k_begin, int k_end, int start) {
+    const int offset = start - (k_begin > 0 ? prefix[k_begin - 1] : 0);
+    const __m256i offsets = _mm256_set1_epi32(offset);
+    __m256i sum = _mm256_setzero_si256();
+    int k = k_begin;
+    for (; k + 8 <= k_end; k += 8) {
+        __m256i shifted = _mm256_add_epi32(offsets, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prefix + k)));
+        sum = _mm256_add_epi32(sum, _mm256_max_epi32(shifted, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(completions + k))));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    unsigned total = 0;
+    for (int l = 0; l < 8; l++) total += static_cast<unsigned>(lanes[l]);
+    for (; k < k_end; k++) total += static_cast<unsigned>(std::max(offset + prefix[k], completions[k]));
+    return static_cast<int>(total);
+}
+
+__attribute__((target("avx512f")))
+inline void max_plus_scan_block_avx512(const int* tasks, int k_begin, int k_end, const int* durations, const int* releaseDates, int* completions) {
+    const __m512i none = _mm512_set1_epi32(-(1 << 29));
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i last = _mm512_set1_epi32(15);
+    __m512i carry_a = _mm512_setzero_si512();
+    __m512i carry_b = _mm512_setzero_si512();
+    int k = k_begin;
+    for (; k + 16 <= k_end; k += 16) {
+        __m512i index = _mm512_loadu_si512(tasks + k);
+        __m512i a = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, index, durations, 4);
+        __m512i b = _mm512_add_epi32(_mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, index, releaseDates, 4), a);
+        for (int d = 1; d < 16; d *= 2) { //lanes >= d are combined with the lane d places before (the others keep their value)
+            __m512i shift = _mm512_sub_epi32(lanes, _mm512_set1_epi32(d));
+            __mmask16 combined = static_cast<__mmask16>(0xFFFFu << d);
+            __m512i a_prev = _mm512_maskz_permutexvar_epi32(combined, shift, a);
+            __m512i b_prev = _mm512_mask_permutexvar_epi32(none, combined, shift, b);
+            b = _mm512_max_epi32(_mm512_add_epi32(b_prev, a), b);
+            a = _mm512_add_epi32(a_prev, a);
+        }
+        b = _mm512_max_epi32(_mm512_add_epi32(carry_b, a), b);
+        a = _mm512_add_epi32(carry_a, a);
+        _mm512_storeu_si512(completions + k, b);
+        carry_a = _mm512_permutexvar_epi32(last, a);
+        carry_b = _mm512_permutexvar_epi32(last, b);
+    }
+    int current = (k > k_begin) ? completions[k - 1] : 0;
+    for (; k < k_end; k++) {
+        current = std::max(current, releaseDates[tasks[k]]) + durations[tasks[k]];
+        completions[k] = current;
+    }
+}
+
+__attribute__((target("avx512f")))
+inline int max_plus_block_sumci_avx512(const int* prefix, const int* completions, int k_begin, int k_end, int start) {
+    const int offset = start - (k_begin > 0 ? prefix[k_begin - 1] : 0);
+    const __m512i offsets = _mm512_set1_epi32(offset);
+    __m512i sum = _mm512_setzero_si512();
+    int k = k_begin;
+    for (; k + 16 <= k_end; k += 16) {
+        __m512i shifted = _mm512_add_epi32(offsets, _mm512_loadu_si512(prefix + k));
+        sum = _mm512_add_epi32(sum, _mm512_max_epi32(shifted, _mm512_loadu_si512(completions + k)));
+    }
+    alignas(64) int lanes[16];
+    _mm512_store_si512(lanes, sum);
+    unsigned total = 0;
+    for (int l = 0; l < 16; l++) total += static_cast<unsigned>(lanes[l]);
+    for (; k < k_end; k++) total += static_cast<unsigned>(std::max(offset + prefix[k], completions[k]));
+    return static_cast<int>(total);
+}
+#endif
+
+inline void max_plus_scan_block(const int* tasks, int k_begin, int k_end, const int* durations, const int* releaseDates, int* completions) {
+#ifdef SCHEDULE_KERNELS_X86
+    static const int level = __builtin_cpu_supports("avx512f") ? 2 : (__builtin_cpu_supports("avx2") ? 1 : 0);
+    if (level == 2) return max_plus_scan_block_avx512(tasks, k_begin, k_end, durations, releaseDates, completions);
+    if (level == 1) return max_plus_scan_block_avx2(tasks, k_begin, k_end, durations, releaseDates, completions);
+#endif
+    max_plus_scan_block_scalar(tasks, k_begin, k_end, durations, releaseDates, completions);
+}
+
+inline int max_plus_block_sumci(const int* prefix, const int* completions, int k_begin, int k_end, int start) {
+#ifdef SCHEDULE_KERNELS_X86
+    static const int level = __builtin_cpu_supports("avx512f") ? 2 : (__builtin_cpu_supports("avx2") ? 1 : 0);
+    if (level == 2) return max_plus_block_sumci_avx512(prefix, completions, k_begin, k_end, start);
+    if (level == 1) return max_plus_block_sumci_avx2(prefix, completions, k_begin, k_end, start);
+#endif
+    return max_plus_block_sumci_scalar(prefix, completions, k_begin, k_end, start);
+}
+
+// First mismatch of two int arrays (used by the policies to compare two sequences) : smallest i < n with a[i] != b[i], or n if equal.
+inline int first_mismatch_scalar(const int* a, const int* b, int n) {
+    return std::mismatch(a, a + n, b).first - a;
+}
+
+#ifdef SCHEDULE_KERNELS_X86
+__attribute__((target("avx2")))
+inline int first_mismatch_avx2(const int* a, const int* b, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(equal))) & 0xFFu; //bit l : lane l differs
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + first_mismatch_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+inline int first_mismatch_avx512(const int* a, const int* b, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __mmask16 mask = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + first_mismatch_avx2(a + i, b + i, n - i);
+}
+#endif
+
+inline int first_mismatch(const int* a, const int* b, int n) {
+#ifdef SCHEDULE_KERNELS_X86
+    static const int level = __builtin_cpu_supports("avx512f") ? 2 : (__builtin_cpu_supports("avx2") ? 1 : 0);
+    if (level == 2) return first_mismatch_avx512(a, b, n);
+    if (level == 1) return first_mismatch_avx2(a, b, n);
+#endif
+    return first_mismatch_scalar(a, b, n);
+}
+
+#endif // SCHEDULE_KERNELS_H
@@ -0,0 +1,31 @@
+#ifndef SCORE_MATRIX_H
+#define SCORE_MATRIX_H
+
+#include "SequencePool.h"
+#include <vector>
+
+// Scores of M candidate metasolutions in the S scenarios of an instance, as returned by Policy::evaluate_many (dense, candidate-major).
+// Front sequences stay in the candidates (front_sequences) : front_id(m, s) is the SequencePool handle of the front of candidate m in scenario s,
+// equal ids <=> same sequence (valid as long as the candidate keeps this evaluation).
+struct ScoreMatrix {
+    int nb_candidates = 0;
+    int nb_scenarios = 0;
+    std::vector<int> scores; //scores[m * nb_scenarios + s]
+    std::vector<SequenceHandle> front_ids; //same layout
+    std::vector<int> aggregates; //aggregated score of each candidate (see Policy::set_aggregator)
+
+    const int* row(int m) const { return scores.data() + static_cast<size_t>(m) * nb_scenarios; }
+    int score(int m, int s) const { return scores[static_cast<size_t>(m) * nb_scenarios + s]; }
+    SequenceHandle front_id(int m, int s) const { return front_ids[static_cast<size_t>(m) * nb_scenarios + s]; }
+
+    //candidate with the smallest aggregate (the first one if tie), -1 if there is none
+    int best_candidate() const {
+        int best = -1;
+        for (int m = 0; m < nb_candidates; m++) {
+            if (best < 0 || aggregates[m] < aggregates[best]) best = m;
+        }
+        return best;
+    }
+};
+
+#endif // SCORE_MATRIX_H
@@ -0,0 +1,117 @@
+#ifndef SCORE_MEMO_H
+#define SCORE_MEMO_H
+
+#include "SequencePool.h"
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// Content of a metasolution (see MetaSolution::fingerprint) as two 64 bits hashes with independent mixers : the score memo matches both,
+// so a wrong hit needs both to collide. All zero : not memoized
+struct Fingerprint {
+    uint64_t hash = 0;
+    uint64_t check = 0;
+
+    void mix(uint64_t value) {
+        hash = mix_hash(hash, value);
+        check += value * 0xc2b2ae3d27d4eb4fULL + 0x165667b19e3779f9ULL;
+        check ^= check >> 29;
+        check *= 0x94d049bb133111ebULL;
+        check ^= check >> 32;
+    }
+    bool memoized() const { return hash != 0 || check != 0; }
+
+    static uint64_t mix_hash(uint64_t h, uint64_t value) {
+        h ^= value + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h *= 0xff51afd7ed558ccdULL;
+        return h ^ (h >> 33);
+    }
+};
+
+// Scores of metasolutions per base scenario, remembered across evaluations (see Policy::set_score_memo). Keyed by the metasolution
+// fingerprint and the base instance and scenario, so the train/test splits of an instance share the results. One memo per policy.
+// The map is split in locked shards and a full shard is emptied : it is a cache.
+class ScoreMemo {
+public:
+    struct Key {
+        uint64_t fingerprint;
+        uint64_t check; //Fingerprint::check : compared, not hashed
+        uint64_t base_instance_id;
+        int base_scenario;
+        bool operator==(const Key& other) const {
+            return fingerprint == other.fingerprint && check == other.check && base_instance_id == other.base_instance_id && base_scenario == other.base_scenario;
+        }
+    };
+
+    struct Entry {
+        int score;
+        int front_index; //index of the sub metasolution used (lists), -1 otherwise
+        bool has_front; //false if recorded without its front (see Policy::evaluate_scores) : front is then EMPTY
+        SequenceHandle front; //expressed sequence (see SequencePool)
+    };
+
+    //at most max_entries results are kept (a full shard is emptied before inserting)
+    explicit ScoreMemo(size_t max_entries) : max_shard_entries(max_entries / NB_SHARDS + 1) {}
+
+    //copies the entry of key in out, the caller then owns a reference to out.front. Returns false if there is none
+    bool find(const Key& key, Entry& out) const {
+        const Shard& shard = shards[shard_of(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) return false;
+        out = it->second;
+        SequencePool::global().retain(out.front);
+        return true;
+    }
+
+    //the memo takes its own reference to entry.front
+    void insert(const Key& key, const Entry& entry) {
+        Shard& shard = shards[shard_of(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.entries.size() >= max_shard_entries) clear_shard(shard);
+        SequencePool::global().retain(entry.front);
+        auto inserted = shard.entries.emplace(key, entry);
+        if (!inserted.second) {
+            SequencePool::global().release(inserted.first->second.front);
+            inserted.first->second = entry;
+        }
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            clear_shard(shard);
+        }
+    }
+
+    ~ScoreMemo() { clear(); }
+
+private:
+    static constexpr size_t NB_SHARDS = 64;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t h = key.fingerprint ^ (key.base_instance_id * 0x9e3779b97f4a7c15ULL) ^ (static_cast<uint64_t>(key.base_scenario) * 0xc2b2ae3d27d4eb4fULL);
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    struct Shard {
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        mutable std::mutex mutex;
+    };
+
+    size_t max_shard_entries;
+    Shard shards[NB_SHARDS];
+
+    static size_t shard_of(const Key& key) { return (KeyHash{}(key) >> 7) % NB_SHARDS; }
+
+    static void clear_shard(Shard& shard) { //called with the lock of the shard
+        for (auto& entry : shard.entries) SequencePool::global().release(entry.second.front);
+        shard.entries.clear();
+    }
+};
+
+#endif // SCORE_MEMO_H
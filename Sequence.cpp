@@ -4,6 +4,8 @@
 // Constructor implementation
 Sequence::Sequence(const std::vector<int>& tasks) : tasks(tasks) {}
 
+Sequence::Sequence(std::vector<int>&& tasks) : tasks(std::move(tasks)) {}
+
 Sequence::Sequence(int n, std::mt19937& rng) {
     tasks.resize(n);
     for (int i = 0; i < n; ++i) {
@@ -131,3 +133,8 @@ Sequence Sequence::gen_swap_neighbor(int swap_index){
 const std::vector<int>& Sequence::get_tasks() const {
     return tasks;
 }
+
+// Writing access, used by policies to extract directly into an existing sequence (reuses its memory)
+std::vector<int>& Sequence::get_tasks_modifiable() {
+    return tasks;
+}
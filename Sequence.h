@@ -17,6 +17,7 @@ class Sequence {
 public:
     // Constructor accepting a vector of task IDs
     Sequence(const std::vector<int>& tasks);
+    Sequence(std::vector<int>&& tasks); //takes the vector over (no copy)
 
     // random constructor
     Sequence(int n, std::mt19937 &rng);
@@ -30,6 +31,7 @@ public:
 
     // Accessor for the task sequence
     const std::vector<int>& get_tasks() const;
+    std::vector<int>& get_tasks_modifiable();
 
     bool check_precedence_constraints(const DataInstance& instance) const;
 
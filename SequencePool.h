@@ -0,0 +1,271 @@
+#ifndef SEQUENCE_POOL_H
+#define SEQUENCE_POOL_H
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+typedef uint32_t SequenceHandle;
+
+//read only view of a sequence of tasks (a pooled sequence, or a std::vector<int>)
+class SequenceView {
+public:
+    SequenceView() {}
+    SequenceView(const int* tasks, int size) : tasks(tasks), length(size) {}
+    SequenceView(const std::vector<int>& tasks) : tasks(tasks.data()), length(tasks.size()) {}
+
+    const int* data() const { return tasks; }
+    int size() const { return length; }
+    int operator[](int i) const { return tasks[i]; }
+    const int* begin() const { return tasks; }
+    const int* end() const { return tasks + length; }
+    std::vector<int> to_vector() const { return std::vector<int>(begin(), end()); }
+
+    bool operator==(const SequenceView& other) const { return length == other.length && std::equal(begin(), end(), other.begin()); }
+    bool operator!=(const SequenceView& other) const { return !(*this == other); }
+
+private:
+    const int* tasks = nullptr;
+    int length = 0;
+};
+
+// Hash-consed storage of the front sequences of metasolutions : equal sequences are stored once and referred to by a 32 bits handle
+// (equal handles <=> equal sequences). A SequenceMetaSolution expresses the same sequence in every scenario and a GSEQ only a few distinct
+// ones, so the fronts of a pool of candidates take little memory and are copied as handles.
+// Sequences are reference counted (see FrontSequences) : the storage of a sequence nobody refers to is freed and its handle reused.
+// At most 2^32 - 1 sequences are alive at once (intern throws beyond). The entry table grows to the peak number of live sequences.
+// Thread safe : the content index is split in shards, each with its own lock. Stored sequences never move, views stay valid while referenced.
+class SequencePool {
+public:
+    static constexpr SequenceHandle EMPTY = 0; //the empty sequence (not counted)
+
+    //the pool shared by all metasolutions (never destroyed : metasolutions may outlive static objects)
+    static SequencePool& global() {
+        static SequencePool* pool = new SequencePool();
+        return *pool;
+    }
+
+    //handle of the sequence tasks[0..n), stored if it is new. The caller owns one reference to it (see release).
+    //Throws std::runtime_error if 2^32 - 1 sequences are already alive
+    SequenceHandle intern(const int* tasks, int n) {
+        if (n == 0) return EMPTY;
+        const uint64_t h = hash(tasks, n);
+        Shard& shard = shards[h % NB_SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto range = shard.handles.equal_range(h);
+        for (auto it = range.first; it != range.second; ++it) {
+            Entry& entry = entry_of(it->second);
+            if (entry.size == n && std::equal(tasks, tasks + n, entry.tasks) && try_retain(entry)) return it->second;
+        }
+        SequenceHandle handle = allocate();
+        Entry& entry = entry_of(handle);
+        entry.tasks = new int[n];
+        std::copy(tasks, tasks + n, entry.tasks);
+        entry.size = n;
+        entry.hash = h;
+        entry.refs.store(1, std::memory_order_relaxed);
+        shard.handles.emplace(h, handle);
+        return handle;
+    }
+    SequenceHandle intern(const std::vector<int>& tasks) { return intern(tasks.data(), tasks.size()); }
+
+    //one more reference to a sequence the caller already refers to
+    void retain(SequenceHandle handle) {
+        if (handle != EMPTY) entry_of(handle).refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //drops one reference. The last one recycles the storage (a dead sequence is never returned by intern again)
+    void release(SequenceHandle handle) {
+        if (handle == EMPTY) return;
+        Entry& entry = entry_of(handle);
+        if (entry.refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        {
+            Shard& shard = shards[entry.hash % NB_SHARDS];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto range = shard.handles.equal_range(entry.hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == handle) { shard.handles.erase(it); break; }
+            }
+        }
+        delete[] entry.tasks; //not reachable anymore : intern compares tasks under the shard lock
+        entry.tasks = nullptr;
+        std::lock_guard<std::mutex> lock(alloc_mutex);
+        free_handles.push_back(handle);
+        live_sequences--;
+    }
+
+    SequenceView view(SequenceHandle handle) const {
+        if (handle == EMPTY) return SequenceView();
+        const Entry& entry = entry_of(handle);
+        return SequenceView(entry.tasks, entry.size);
+    }
+
+    //number of distinct sequences stored
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(alloc_mutex);
+        return live_sequences;
+    }
+
+private:
+    struct Entry {
+        int* tasks = nullptr;
+        int size = 0;
+        uint64_t hash = 0;
+        std::atomic<int> refs{0};
+    };
+
+    struct Shard {
+        std::unordered_multimap<uint64_t, SequenceHandle> handles; //by content hash
+        std::mutex mutex;
+    };
+
+    static constexpr size_t NB_SHARDS = 64;
+    static constexpr int ENTRY_BITS = 16; //entries are allocated by blocks of 2^ENTRY_BITS
+    static constexpr size_t NB_ENTRY_BLOCKS = size_t(1) << (32 - ENTRY_BITS);
+
+    std::unique_ptr<std::atomic<Entry*>[]> entry_blocks{new std::atomic<Entry*>[NB_ENTRY_BLOCKS]()};
+    Shard shards[NB_SHARDS];
+
+    //below : guarded by alloc_mutex
+    mutable std::mutex alloc_mutex;
+    std::vector<std::unique_ptr<Entry[]>> owned_entry_blocks;
+    SequenceHandle next_handle = 1; //0 is EMPTY
+    std::vector<SequenceHandle> free_handles;
+    size_t live_sequences = 0;
+
+    SequencePool() {}
+
+    Entry& entry_of(SequenceHandle handle) const {
+        return entry_blocks[handle >> ENTRY_BITS].load(std::memory_order_acquire)[handle & ((SequenceHandle(1) << ENTRY_BITS) - 1)];
+    }
+
+    //a sequence whose last reference is being released stays dead
+    static bool try_retain(Entry& entry) {
+        int refs = entry.refs.load(std::memory_order_relaxed);
+        while (refs > 0 && !entry.refs.compare_exchange_weak(refs, refs + 1, std::memory_order_relaxed)) {}
+        return refs > 0;
+    }
+
+    //new entry (its tasks are allocated by the caller)
+    SequenceHandle allocate() {
+        std::lock_guard<std::mutex> lock(alloc_mutex);
+        SequenceHandle handle;
+        if (!free_handles.empty()) {
+            handle = free_handles.back();
+            free_handles.pop_back();
+        }
+        else {
+            if (next_handle == 0) throw std::runtime_error("SequencePool is full.");
+            handle = next_handle++;
+            size_t block = handle >> ENTRY_BITS;
+            if (!entry_blocks[block].load(std::memory_order_relaxed)) {
+                owned_entry_blocks.emplace_back(new Entry[size_t(1) << ENTRY_BITS]);
+                entry_blocks[block].store(owned_entry_blocks.back().get(), std::memory_order_release);
+            }
+        }
+        live_sequences++;
+        return handle;
+    }
+
+    static uint64_t hash(const int* tasks, int n) {
+        uint64_t h = 0x9e3779b97f4a7c15ULL ^ static_cast<uint64_t>(n);
+        for (int i = 0; i < n; i++) {
+            h ^= static_cast<uint32_t>(tasks[i]);
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 32;
+        }
+        return h;
+    }
+};
+
+//one reference to a pooled sequence (e.g. from SequencePool::intern), released at the end of the scope
+class PooledSequence {
+public:
+    explicit PooledSequence(SequenceHandle handle) : handle(handle) {}
+    ~PooledSequence() { SequencePool::global().release(handle); }
+    PooledSequence(const PooledSequence&) = delete;
+    PooledSequence& operator=(const PooledSequence&) = delete;
+
+    SequenceHandle get() const { return handle; }
+
+private:
+    SequenceHandle handle;
+};
+
+// Front sequences of a metasolution : one pooled sequence per scenario (SequencePool::EMPTY if there is none yet).
+// Holds one reference to each of its sequences (copies share them). Different scenarios can be written concurrently
+class FrontSequences {
+public:
+    FrontSequences() {}
+    FrontSequences(const FrontSequences& other) : handles(other.handles) {
+        for (SequenceHandle handle : handles) pool().retain(handle);
+    }
+    FrontSequences(FrontSequences&& other) noexcept : handles(std::move(other.handles)) { other.handles.clear(); }
+    FrontSequences& operator=(const FrontSequences& other) {
+        if (this != &other) {
+            for (SequenceHandle handle : other.handles) pool().retain(handle);
+            release_all();
+            handles = other.handles;
+        }
+        return *this;
+    }
+    FrontSequences& operator=(FrontSequences&& other) noexcept {
+        if (this != &other) {
+            release_all();
+            handles = std::move(other.handles);
+            other.handles.clear();
+        }
+        return *this;
+    }
+    ~FrontSequences() { release_all(); }
+
+    size_t size() const { return handles.size(); }
+    bool empty() const { return handles.empty(); }
+    SequenceHandle operator[](size_t s) const { return handles[s]; }
+    SequenceView view(size_t s) const { return pool().view(handles[s]); }
+
+    void resize(size_t n) { //new scenarios have no sequence
+        for (size_t s = n; s < handles.size(); s++) pool().release(handles[s]);
+        handles.resize(n, SequencePool::EMPTY);
+    }
+    void clear() { resize(0); }
+    void erase(size_t s) {
+        pool().release(handles[s]);
+        handles.erase(handles.begin() + s);
+    }
+
+    //scenario s expresses handle (shared with its other owners)
+    void set(size_t s, SequenceHandle handle) {
+        pool().retain(handle);
+        pool().release(handles[s]);
+        handles[s] = handle;
+    }
+    //scenario s expresses handle, taking over the reference of the caller (e.g. returned by SequencePool::intern)
+    void adopt(size_t s, SequenceHandle handle) {
+        pool().release(handles[s]);
+        handles[s] = handle;
+    }
+    //scenario s expresses tasks (interned : see the capacity of SequencePool)
+    void store(size_t s, SequenceView tasks) { adopt(s, pool().intern(tasks.data(), tasks.size())); }
+    //every scenario expresses handle
+    void fill(SequenceHandle handle) {
+        for (size_t s = 0; s < handles.size(); s++) set(s, handle);
+    }
+
+private:
+    std::vector<SequenceHandle> handles;
+
+    static SequencePool& pool() { return SequencePool::global(); }
+    void release_all() {
+        for (SequenceHandle handle : handles) pool().release(handle);
+        handles.clear();
+    }
+};
+
+#endif // SEQUENCE_POOL_H
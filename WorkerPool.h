@@ -0,0 +1,118 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+
+//helper pool of persistent worker threads. Used to split scenario ranges when evaluating metasolutions.
+//parallel_for(n, fn) calls fn(0..n-1) once each, spread over the workers and the calling thread, and returns when all calls are done.
+//A parallel_for issued from inside a worker runs inline (no nested parallelism, avoids deadlocks).
+class WorkerPool {
+public:
+    explicit WorkerPool(int nb_threads) {
+        for (int i = 1; i < nb_threads; i++) { //calling thread counts as one worker
+            workers.emplace_back([this]() { worker_loop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            stopping = true;
+        }
+        wake_workers.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return workers.size() + 1; }
+
+    void parallel_for(int nb_tasks, const std::function<void(int)>& fn) {
+        if (nb_tasks <= 0) return;
+        if (workers.empty() || nb_tasks == 1 || inside_worker()) { //nothing to gain, run inline
+            for (int t = 0; t < nb_tasks; t++) fn(t);
+            return;
+        }
+
+        std::lock_guard<std::mutex> job_lock(job_mutex); //one job at a time (several threads may share the pool)
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            job = &fn;
+            job_size = nb_tasks;
+            next_task.store(0);
+            active_workers = workers.size();
+            job_error = nullptr;
+            generation++;
+        }
+        wake_workers.notify_all();
+
+        inside_worker() = true;
+        run_tasks(); //calling thread works too
+        inside_worker() = false;
+
+        std::unique_lock<std::mutex> lock(state_mutex);
+        job_done.wait(lock, [this]() { return active_workers == 0; });
+        job = nullptr;
+        if (job_error) std::rethrow_exception(job_error);
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex job_mutex; //serializes jobs
+    std::mutex state_mutex; //protects the fields below
+    std::condition_variable wake_workers;
+    std::condition_variable job_done;
+    const std::function<void(int)>* job = nullptr;
+    int job_size = 0;
+    std::atomic<int> next_task{0}; //dynamic scheduling : workers grab the next task index
+    size_t active_workers = 0;
+    std::exception_ptr job_error = nullptr;
+    unsigned long generation = 0; //incremented for each job, wakes workers
+    bool stopping = false;
+
+    static bool& inside_worker() {
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    void run_tasks() {
+        int t;
+        while ((t = next_task.fetch_add(1)) < job_size) {
+            try {
+                (*job)(t);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (!job_error) job_error = std::current_exception(); //keep the first error, rethrown by the caller
+                next_task.store(job_size); //skip remaining tasks
+            }
+        }
+    }
+
+    void worker_loop() {
+        inside_worker() = true;
+        unsigned long seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(state_mutex);
+                wake_workers.wait(lock, [&]() { return stopping || generation != seen_generation; });
+                if (stopping) return;
+                seen_generation = generation;
+            }
+            run_tasks();
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                active_workers--;
+                if (active_workers == 0) job_done.notify_one();
+            }
+        }
+    }
+};
+
+#endif // WORKER_POOL_H
@@ -1,3 +1,4 @@
+#include "ScenarioMatrix.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -70,7 +71,7 @@ public:
 
         // 2. Hierarchical Base Release Date Generation
         std::uniform_int_distribution<int> r_dist(0, half_sum);//possible base release dates.
-        std::vector<std::vector<int>> cluster_scenarios(cluster_number, std::vector<int>(N));
+        ScenarioMatrix cluster_scenarios(cluster_number, N);
         std::vector<int> global_base_R(N);//used when inter_cluster_var is not maximal (value 1)
 
 
@@ -85,7 +86,7 @@ public:
         }
 
         // 2bis. Scenario Sampling 
-        std::vector<std::vector<int>> scenarios(S, std::vector<int>(N));
+        ScenarioMatrix scenarios(S, N);
         std::uniform_int_distribution<int> sample_pick(0, cluster_number-1);
         std::normal_distribution<double> intra_var_gen(0, half_sum * intra_cluster_var);
 
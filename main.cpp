@@ -141,6 +141,7 @@ int main(int argc, char* argv[]) {
     int jseq_time = 10;                     // Time allocated to jseq solver (seconds)
     int nb_training_scenarios = 1;  //this is the number of training scenarios : S
     int sampling_iterations = 1; //number of times to repeat the sampling / solve / evaluation process (HIgher number is more significant)
+    int nb_threads = 1; //number of threads used by the policy to evaluate scenarios (1 = sequential)
 
     // Command-line arguments override defaults:
     // Usage: ./program <intParam> <fileName> <doubleParam>
@@ -173,13 +174,22 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (argc > 5) { 
+        try {
+            nb_threads = std::stoi(argv[5]);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Invalid integer parameter. Using default: " << nb_threads << "\n";
+        }
+    }
+
     // Display the parameters used
     std::cout << std:: endl << "==== Input (or default) parameters ===" << std::endl;
 
     std::cout << "file_name: " << file_name << "\n"
               << "jseq_time: " << jseq_time << "\n"
               << "nb_training_scenarios: " << nb_training_scenarios << "\n"
-              << "sampling_iterations: " << sampling_iterations << "\n";
+              << "sampling_iterations: " << sampling_iterations << "\n"
+              << "nb_threads: " << nb_threads << "\n";
 
 
     // Start of actual process
@@ -211,6 +221,11 @@ int main(int argc, char* argv[]) {
     FIFOPolicy used_policy; //fifo policy
     // SPTPolicy used_policy; //spt policy
     // RCPSPPolicy used_policy; //rcpsp policy
+    used_policy.set_threads(nb_threads);
+    // used_policy.set_objective(ObjectiveKind::MAKESPAN); //scenario objective (default : sumci)
+    // used_policy.set_aggregator(Aggregator::quantile(0.9)); //optimize the reported 90th percentile instead of the worst scenario (default : max)
+    used_policy.set_score_memo(std::max<size_t>(1024, (size_t(1) << 25) / instance.getN())); //scenario results shared by the iterations (about 128MB of front sequences)
+    used_policy.set_group_order_memo(std::max<size_t>(1024, (size_t(1) << 25) / instance.getN())); //ordered groups shared by the GSEQ candidates (at most as big)
     std::cout << "Policy : " << used_policy.name << std::endl;
 
     //solvers
@@ -242,7 +257,7 @@ int main(int argc, char* argv[]) {
         ideal_solver.setMaxTime(jseq_time);
         ideal_test_solution = ideal_solver.solve(*testInstance);
         std::cout<<"Ideal training score : " << ideal.evaluate_meta(*ideal_train_solution, *trainInstance) << std::endl; 
-        std::cout<<"Ideal testing score : " << ideal.evaluate_meta(*ideal_test_solution, *testInstance) << std::endl; 
+        std::cout<<"Ideal testing score : " << ideal.evaluate_scores(*ideal_test_solution, *testInstance) << std::endl; 
         std::cout<<"Ideal testing 90q : " << ideal_test_solution->get_quantile(0.9, ideal, *testInstance) << std::endl; 
         std::cout<<"Ideal testing scenario scores : " << vec_to_string(ideal_test_solution->get_scores(ideal,*testInstance)) << std::endl; 
 
@@ -251,7 +266,7 @@ int main(int argc, char* argv[]) {
         //Pure policy -> Fully reactive solution
         pure_policy_solution = PolicySolver.solve(*trainInstance); //resolving isn't necessary as the solution is identical no matter the input training scenarios, however, solve time is negligeable
         std::cout<<"Pure policy training score : " << used_policy.evaluate_meta(*pure_policy_solution,*trainInstance) << std::endl; 
-        std::cout<<"Pure policy testing score : " << used_policy.evaluate_meta(*pure_policy_solution,*testInstance) << std::endl; 
+        std::cout<<"Pure policy testing score : " << used_policy.evaluate_scores(*pure_policy_solution,*testInstance) << std::endl; 
         std::cout<<"Pure policy testing 90q : " << pure_policy_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         std::cout<<"Pure policy testing scenario scores : " << vec_to_string(pure_policy_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -259,7 +274,7 @@ int main(int argc, char* argv[]) {
         //CPO -> JSEQ solution
         jseq_solution = JseqSolver.solve(*trainInstance);
         std::cout<<"JSEQ training score : " << used_policy.evaluate_meta(*jseq_solution,*trainInstance) << std::endl; 
-        std::cout<<"JSEQ testing score : " << used_policy.evaluate_meta(*jseq_solution,*testInstance) << std::endl; 
+        std::cout<<"JSEQ testing score : " << used_policy.evaluate_scores(*jseq_solution,*testInstance) << std::endl; 
         std::cout<<"JSEQ testing 90q : " << jseq_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         std::cout<<"JSEQ testing scenario scores : " << vec_to_string(jseq_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -267,7 +282,7 @@ int main(int argc, char* argv[]) {
         EWSolver.set_initial_solution(*jseq_solution);
         gseq_solution = EWSolver.solve(*trainInstance);
         std::cout<<"GSEQ training score : " << used_policy.evaluate_meta(*gseq_solution,*trainInstance) << std::endl; 
-        std::cout<<"GSEQ testing score : " << used_policy.evaluate_meta(*gseq_solution,*testInstance) << std::endl; 
+        std::cout<<"GSEQ testing score : " << used_policy.evaluate_scores(*gseq_solution,*testInstance) << std::endl; 
         std::cout<<"GSEQ testing 90q : " << gseq_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         std::cout<<"GSEQ testing scenario scores : " << vec_to_string(gseq_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -287,7 +302,7 @@ int main(int argc, char* argv[]) {
         }
         std::cout << "SJSEQ size :" << (dynamic_cast<ListMetaSolution<SequenceMetaSolution>*>(sjseq_solution))->get_meta_solutions_size()<<std::endl; 
         std::cout<<"SJSEQ training score : " << used_policy.evaluate_meta(*sjseq_solution,*trainInstance) << std::endl;                 
-        std::cout<<"SJSEQ testing score : " << used_policy.evaluate_meta(*sjseq_solution,*testInstance) << std::endl; 
+        std::cout<<"SJSEQ testing score : " << used_policy.evaluate_scores(*sjseq_solution,*testInstance) << std::endl; 
         std::cout<<"SJSEQ testing 90q : " << sjseq_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         std::cout<<"SJSEQ testing scenario scores : " << vec_to_string(sjseq_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -296,7 +311,7 @@ int main(int argc, char* argv[]) {
         clean_sjseq_solution = (dynamic_cast<ListMetaSolution<SequenceMetaSolution>*>(sjseq_solution))->front_sub_metasolutions(&used_policy,*trainInstance);
         std::cout << "SJSEQ Front size :" << (dynamic_cast<ListMetaSolution<SequenceMetaSolution>*>(clean_sjseq_solution))->get_meta_solutions_size()<<std::endl; 
         std::cout<<"SJSEQ Front training score : " << used_policy.evaluate_meta(*clean_sjseq_solution,*trainInstance) << std::endl; 
-        std::cout<<"SJSEQ Front testing score : " << used_policy.evaluate_meta(*clean_sjseq_solution,*testInstance) << std::endl; 
+        std::cout<<"SJSEQ Front testing score : " << used_policy.evaluate_scores(*clean_sjseq_solution,*testInstance) << std::endl; 
         std::cout<<"SJSEQ Front testing 90q : " << clean_sjseq_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         std::cout<<"SJSEQ Front testing scenario scores : " << vec_to_string(clean_sjseq_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -310,7 +325,7 @@ int main(int argc, char* argv[]) {
         //     bestk_greedy_seq.set_initial_solution(*sjseq_greedy_solution);
         //     std::cout << "SJSEQ" << k << " greedy size :" << (dynamic_cast<ListMetaSolution<SequenceMetaSolution>*>(sjseq_greedy_solution))->get_meta_solutions_size()<<std::endl; 
         //     std::cout<<"SJSEQ" << k << " greedy training score : " << used_policy.evaluate_meta(*sjseq_greedy_solution,*trainInstance) << std::endl;                 
-        //     std::cout<<"SJSEQ" << k << " greedy testing score : " << used_policy.evaluate_meta(*sjseq_greedy_solution,*testInstance) << std::endl; 
+        //     std::cout<<"SJSEQ" << k << " greedy testing score : " << used_policy.evaluate_scores(*sjseq_greedy_solution,*testInstance) << std::endl; 
         //     std::cout<<"SJSEQ" << k << " greedy testing 90q : " << sjseq_greedy_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         //     std::cout<<"SJSEQ" << k << " greedy testing scenario scores : " << vec_to_string(sjseq_greedy_solution->get_scores(used_policy,*testInstance)) << std::endl; 
         // }   
@@ -353,7 +368,7 @@ int main(int argc, char* argv[]) {
         // }
         // std::cout << "SJSEQ simple size :" << (dynamic_cast<ListMetaSolution<SequenceMetaSolution>*>(sjseq_simple_solution))->get_meta_solutions_size()<<std::endl; 
         // std::cout<< "SJSEQ simple training score : " << used_policy.evaluate_meta(*sjseq_simple_solution,*trainInstance) << std::endl;                 
-        // std::cout<< "SJSEQ simple testing score : " << used_policy.evaluate_meta(*sjseq_simple_solution,*testInstance) << std::endl; 
+        // std::cout<< "SJSEQ simple testing score : " << used_policy.evaluate_scores(*sjseq_simple_solution,*testInstance) << std::endl; 
         // std::cout<< "SJSEQ simple testing 90q : " << sjseq_simple_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         // std::cout<< "SJSEQ simple testing scenario scores : " << vec_to_string(sjseq_simple_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -402,14 +417,12 @@ int main(int argc, char* argv[]) {
         if (added_back > 0) {std::cout << "Added back " << added_back << " truncated solutions to GSEQ set after EW." << std::endl;}
         std::cout << "number of diversifiedsol gseq :" <<AllSolutionsGroup.size()<<std::endl;
 
-        //searching All GSEQ solutions for the best one
-        int best_GSEQ_sofar = 0;
-        for (int k = 0; k<AllSolutionsGroup.size(); k++){
-            if ((!AllSolutionsGroup[k].scored_by) || (AllSolutionsGroup[k].scored_for != trainInstance)){used_policy.evaluate_meta( AllSolutionsGroup[k],*trainInstance);}//checking it is scored and by the*trainInstance
-            if (AllSolutionsGroup[k].score <  AllSolutionsGroup[best_GSEQ_sofar].score){best_GSEQ_sofar = k;}
-        }
+        //searching All GSEQ solutions for the best one (scored together on the training scenarios, those already scored are kept)
+        std::vector<MetaSolution*> gseqCandidates;
+        for (auto& gseq : AllSolutionsGroup) gseqCandidates.push_back(&gseq);
+        int best_GSEQ_sofar = std::max(0, used_policy.evaluate_many(gseqCandidates, *trainInstance).best_candidate());
         std::cout<<"Best GSEQ training score : " << used_policy.evaluate_meta(AllSolutionsGroup[best_GSEQ_sofar],*trainInstance) << std::endl; //check to see if best-of is usefulll (or rather, if the tested instances benefit from best of. If they don't, could mean SGSEQ are not usefull in general on instances, or could just mean it's a property of the instance.)
-        std::cout<<"Best GSEQ testing score : " << used_policy.evaluate_meta(AllSolutionsGroup[best_GSEQ_sofar],*testInstance) << std::endl; 
+        std::cout<<"Best GSEQ testing score : " << used_policy.evaluate_scores(AllSolutionsGroup[best_GSEQ_sofar],*testInstance) << std::endl; 
         std::cout<<"Best GSEQ testing 90q : " << AllSolutionsGroup[best_GSEQ_sofar].get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         std::cout<<"Best GSEQ testing scenario scores : " << vec_to_string(AllSolutionsGroup[best_GSEQ_sofar].get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -423,7 +436,7 @@ int main(int argc, char* argv[]) {
         }
         std::cout << "SGSEQ size :" << (dynamic_cast<ListMetaSolution<GroupMetaSolution>*>(sgseq_solution))->get_meta_solutions_size()<<std::endl; 
         std::cout<<"SGSEQ training score : " << used_policy.evaluate_meta(*sgseq_solution,*trainInstance) << std::endl; 
-        std::cout<<"SGSEQ testing score : " << used_policy.evaluate_meta(*sgseq_solution,*testInstance) << std::endl; 
+        std::cout<<"SGSEQ testing score : " << used_policy.evaluate_scores(*sgseq_solution,*testInstance) << std::endl; 
         std::cout<<"SGSEQ testing 90q : " << sgseq_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         std::cout<<"SGSEQ testing scenario scores : " << vec_to_string(sgseq_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -432,7 +445,7 @@ int main(int argc, char* argv[]) {
         clean_sgseq_solution = (dynamic_cast<ListMetaSolution<GroupMetaSolution>*>(sgseq_solution))->front_sub_metasolutions(&used_policy,*trainInstance);
         std::cout << "SGSEQ Front size :" << (dynamic_cast<ListMetaSolution<GroupMetaSolution>*>(clean_sgseq_solution))->get_meta_solutions_size()<<std::endl; 
         std::cout<<"SGSEQ Front training score : " << used_policy.evaluate_meta(*clean_sgseq_solution,*trainInstance) << std::endl; 
-        std::cout<<"SGSEQ Front testing score : " << used_policy.evaluate_meta(*clean_sgseq_solution,*testInstance) << std::endl; //note that the "front" of a SGSEQ also should have the same training score, however, there can exists several different fronts, that can behave differently in testing. The front isn't unique
+        std::cout<<"SGSEQ Front testing score : " << used_policy.evaluate_scores(*clean_sgseq_solution,*testInstance) << std::endl; //note that the "front" of a SGSEQ also should have the same training score, however, there can exists several different fronts, that can behave differently in testing. The front isn't unique
         std::cout<<"SGSEQ Front testing 90q : " << clean_sgseq_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         std::cout<<"SGSEQ Front testing scenario scores : " << vec_to_string(clean_sgseq_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
@@ -446,7 +459,7 @@ int main(int argc, char* argv[]) {
         //     bestk_greedy_group.set_initial_solution(*sgseq_greedy_solution);
         //     std::cout << "SGSEQ"<< k << " greedy size :" << (dynamic_cast<ListMetaSolution<GroupMetaSolution>*>(sgseq_greedy_solution))->get_meta_solutions_size()<<std::endl; 
         //     std::cout<<"SGSEQ"<< k << " greedy training score : " << used_policy.evaluate_meta(*sgseq_greedy_solution,*trainInstance) << std::endl;                 
-        //     std::cout<<"SGSEQ"<< k << " greedy testing score : " << used_policy.evaluate_meta(*sgseq_greedy_solution,*testInstance) << std::endl; 
+        //     std::cout<<"SGSEQ"<< k << " greedy testing score : " << used_policy.evaluate_scores(*sgseq_greedy_solution,*testInstance) << std::endl; 
         //     std::cout<<"SGSEQ"<< k << " greedy testing 90q : " << sgseq_greedy_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         //     std::cout<<"SGSEQ"<< k << " greedy testing scenario scores : " << vec_to_string(sgseq_greedy_solution->get_scores(used_policy,*testInstance)) << std::endl; 
         // }   
@@ -461,7 +474,7 @@ int main(int argc, char* argv[]) {
         // //reducing to front
         // std::cout << "SGSEQTEST size :" << (dynamic_cast<ListMetaSolution<GroupMetaSolution>*>(sgseq_test_solution))->get_meta_solutions_size()<<std::endl; 
         // std::cout<<"SGSEQTEST training score : " << used_policy.evaluate_meta(*sgseq_test_solution,*trainInstance) << std::endl; 
-        // std::cout<<"SGSEQTEST testing score : " << used_policy.evaluate_meta(*sgseq_test_solution,*testInstance) << std::endl; 
+        // std::cout<<"SGSEQTEST testing score : " << used_policy.evaluate_scores(*sgseq_test_solution,*testInstance) << std::endl; 
         // std::cout<<"SGSEQTEST scenario scores : " << vec_to_string(sgseq_test_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
         // subsplit_number = 5; // copy of SJSEQ version. Could use template instead
@@ -501,7 +514,7 @@ int main(int argc, char* argv[]) {
         // }
         // std::cout << "SGSEQ simple size :" << (dynamic_cast<ListMetaSolution<GroupMetaSolution>*>(sgseq_simple_solution))->get_meta_solutions_size()<<std::endl; 
         // std::cout<< "SGSEQ simple training score : " << used_policy.evaluate_meta(*sgseq_simple_solution,*trainInstance) << std::endl;                 
-        // std::cout<< "SGSEQ simple testing score : " << used_policy.evaluate_meta(*sgseq_simple_solution,*testInstance) << std::endl; 
+        // std::cout<< "SGSEQ simple testing score : " << used_policy.evaluate_scores(*sgseq_simple_solution,*testInstance) << std::endl; 
         // std::cout<< "SGSEQ simple testing 90q : " << sgseq_simple_solution->get_quantile(0.9, used_policy,*testInstance) << std::endl; 
         // std::cout<< "SGSEQ simple testing scenario scores : " << vec_to_string(sgseq_simple_solution->get_scores(used_policy,*testInstance)) << std::endl; 
 
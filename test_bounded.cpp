@@ -0,0 +1,97 @@
+#include "Instance.h"
+#include "Sequence.h"
+#include "Policy.h"
+#include "PolicyFifo.h"
+#include "PolicySPT.h"
+#include "MetaSolutions.h"
+#include <iostream>
+#include <vector>
+#include <random>
+
+// Checks that bounded evaluations agree with unbounded ones : for every aggregator, a complete bounded evaluation has the score of the
+// full evaluation (and is within the bound), an incomplete one means the full score is above the bound, and evaluating again without bound
+// gives the full scenario scores. Run with and without a scenario order, on one and several threads. Exits with 1 on a disagreement.
+
+static int check_bounded(const char* name, Policy& policy, std::vector<MetaSolution*>& fresh, std::vector<MetaSolution*>& reference,
+                         const DataInstance& instance, const std::vector<int>* scenario_order) {
+    int failures = 0;
+    for (size_t i = 0; i < fresh.size(); i++) {
+        reference[i]->reset_evaluation();
+        int full = policy.evaluate_meta(*reference[i], instance);
+        for (int percent : {50, 90, 100, 110}) {
+            int bound = full * percent / 100;
+            for (bool keep_fronts : {true, false}) {
+                MetaSolution& metasol = *fresh[i];
+                metasol.reset_evaluation();
+                EvaluationResult result = policy.evaluate_meta_bounded(metasol, instance, bound, scenario_order, keep_fronts);
+                bool good = result.complete ? (result.score == full && full <= bound) : full > bound;
+                int again = policy.evaluate_meta(metasol, instance); //resumes the partial evaluation
+                good = good && again == full && metasol.scores == reference[i]->scores;
+                if (!good) {
+                    if (failures++ < 5) std::cout << name << " : candidate " << i << " bound " << bound << " complete " << result.complete << " gives "
+                                                  << result.score << " then " << again << " (Expected: " << full << ")" << std::endl;
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+int main() {
+    try {
+        SingleMachineInstance base("instances/bench_1p_var/bench_1p_var_N100_prec0.01_I0_S1000_var0.3.data");
+        std::mt19937 rng(7);
+        DataInstance *train, *test;
+        std::tie(train, test) = base.SampleSplitScenarios(40, rng, false);
+
+        std::vector<SequenceMetaSolution> sequences;
+        std::vector<GroupMetaSolution> groups;
+        for (int i = 0; i < 6; i++) {
+            Sequence sequence(base.getN(), rng);
+            sequences.push_back(SequenceMetaSolution(sequence.fix_precedence_constraints(base)));
+            GroupMetaSolution* group = sequences.back().to_gseq();
+            for (int m = 0; m < 60; m++) {
+                GroupMetaSolution* merged = group->merge_groups(std::uniform_int_distribution<int>(0, group->nb_groups() - 2)(rng));
+                delete group;
+                group = merged;
+            }
+            groups.push_back(*group);
+            delete group;
+        }
+        std::vector<SequenceMetaSolution> sequence_copies(sequences);
+        std::vector<GroupMetaSolution> group_copies(groups);
+        std::vector<MetaSolution*> fresh, reference;
+        for (size_t i = 0; i < sequences.size(); i++) { fresh.push_back(&sequences[i]); reference.push_back(&sequence_copies[i]); }
+        for (size_t i = 0; i < groups.size(); i++) { fresh.push_back(&groups[i]); reference.push_back(&group_copies[i]); }
+
+        //an order learnt from the triggers, as the algorithms do (see ScenarioOrdering)
+        ScenarioOrdering& ordering = test->get_scenario_ordering();
+        for (int k = 0; k < 30; k++) ordering.record_trigger(std::uniform_int_distribution<int>(0, test->getS() - 1)(rng));
+
+        int failures = 0;
+        const std::vector<std::pair<std::string, Aggregator>> aggregators = {{"max", Aggregator::max()}, {"q90", Aggregator::quantile(0.9)},
+                                                                             {"cvar80", Aggregator::cvar(0.8)}, {"mean", Aggregator::mean()}};
+        for (const auto& [aggregator_name, aggregator] : aggregators) {
+            for (int threads : {1, 4}) {
+                FIFOPolicy fifo;
+                SPTPolicy spt;
+                for (Policy* policy : {static_cast<Policy*>(&fifo), static_cast<Policy*>(&spt)}) {
+                    policy->set_aggregator(aggregator);
+                    policy->set_threads(threads);
+                    std::string name = std::string(policy == &fifo ? "fifo" : "spt") + " " + aggregator_name + " " + std::to_string(threads) + " threads";
+                    int found = check_bounded(name.c_str(), *policy, fresh, reference, *test, nullptr)
+                              + check_bounded((name + " ordered").c_str(), *policy, fresh, reference, *test, &ordering.order());
+                    std::cout << name << " : " << (found ? "FAILED" : "ok") << std::endl;
+                    failures += found;
+                }
+            }
+        }
+        delete train;
+        delete test;
+        return failures ? 1 : 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,111 @@
+#include "ScheduleKernels.h"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+
+// Checks the vectorized schedule kernels against the plain ERD recurrence on random instances.
+// Build with "make test_kernels" (no CPLEX needed), exits with 1 if a kernel disagrees.
+
+//sumci of the ERD schedule of tasks in scenario s, release dates task-major
+static int reference_sumci(const std::vector<int>& tasks, const std::vector<int>& durations, const std::vector<int>& releaseByTask, int stride, int s) {
+    int current = 0;
+    unsigned sum = 0;
+    for (int task : tasks) {
+        current = std::max(current, releaseByTask[static_cast<size_t>(task) * stride + s]) + durations[task];
+        sum += static_cast<unsigned>(current);
+    }
+    return static_cast<int>(sum);
+}
+
+typedef void (*SumciKernel)(const int*, int, const int*, const int*, int, int, int, int*);
+
+static int check_sequence_sumci(const char* name, SumciKernel kernel, std::mt19937& rng) {
+    int failures = 0;
+    for (int trial = 0; trial < 200; trial++) {
+        int n = std::uniform_int_distribution<int>(1, 150)(rng);
+        int S = std::uniform_int_distribution<int>(1, 70)(rng);
+        int horizon = std::uniform_int_distribution<int>(1, 5000)(rng);
+        int stride = S + std::uniform_int_distribution<int>(0, 5)(rng); //rows may be padded
+        std::vector<int> durations(n), releaseByTask(static_cast<size_t>(n) * stride, -1);
+        for (int& p : durations) p = std::uniform_int_distribution<int>(1, 100)(rng);
+        for (int task = 0; task < n; task++)
+            for (int s = 0; s < S; s++) releaseByTask[static_cast<size_t>(task) * stride + s] = std::uniform_int_distribution<int>(0, horizon)(rng);
+        std::vector<int> tasks(n);
+        std::iota(tasks.begin(), tasks.end(), 0);
+        std::shuffle(tasks.begin(), tasks.end(), rng);
+
+        int s_begin = std::uniform_int_distribution<int>(0, S - 1)(rng);
+        std::vector<int> out(S, -1);
+        kernel(tasks.data(), n, durations.data(), releaseByTask.data(), stride, s_begin, S, out.data());
+        for (int s = 0; s < S; s++) {
+            int expected = s < s_begin ? -1 : reference_sumci(tasks, durations, releaseByTask, stride, s);
+            if (out[s] != expected) {
+                if (failures++ < 5) std::cout << name << " : n=" << n << " S=" << S << " scenario " << s << " gives " << out[s] << " (Expected: " << expected << ")" << std::endl;
+            }
+        }
+    }
+    std::cout << name << " : " << (failures ? "FAILED" : "ok") << std::endl;
+    return failures;
+}
+
+typedef void (*ScanKernel)(const int*, int, int, const int*, const int*, int*);
+typedef int (*BlockSumciKernel)(const int*, const int*, int, int, int);
+
+//sumci of a long sequence cut in blocks, composed like Policy::scan_fixed_sequence, against the recurrence in one scenario
+static int check_max_plus_scan(const char* name, ScanKernel scan, BlockSumciKernel block_sumci, std::mt19937& rng) {
+    int failures = 0;
+    for (int trial = 0; trial < 200; trial++) {
+        int n = std::uniform_int_distribution<int>(1, 3000)(rng);
+        int block = std::uniform_int_distribution<int>(1, 300)(rng);
+        int horizon = std::uniform_int_distribution<int>(0, 50 * n)(rng);
+        std::vector<int> durations(n), releaseDates(n);
+        for (int& p : durations) p = std::uniform_int_distribution<int>(1, 100)(rng);
+        for (int& r : releaseDates) r = std::uniform_int_distribution<int>(0, horizon)(rng);
+        std::vector<int> tasks(n);
+        std::iota(tasks.begin(), tasks.end(), 0);
+        std::shuffle(tasks.begin(), tasks.end(), rng);
+
+        std::vector<int> prefix(n), completions(n);
+        int total = 0;
+        for (int k = 0; k < n; k++) prefix[k] = (total += durations[tasks[k]]);
+        for (int k_begin = 0; k_begin < n; k_begin += block) scan(tasks.data(), k_begin, std::min(n, k_begin + block), durations.data(), releaseDates.data(), completions.data());
+        int start = 0;
+        unsigned sum = 0;
+        for (int k_begin = 0; k_begin < n; k_begin += block) {
+            int k_end = std::min(n, k_begin + block);
+            sum += static_cast<unsigned>(block_sumci(prefix.data(), completions.data(), k_begin, k_end, start));
+            start = std::max(start + prefix[k_end - 1] - (k_begin > 0 ? prefix[k_begin - 1] : 0), completions[k_end - 1]);
+        }
+        int expected = reference_sumci(tasks, durations, releaseDates, 1, 0);
+        if (static_cast<int>(sum) != expected) {
+            if (failures++ < 5) std::cout << name << " : n=" << n << " block=" << block << " gives " << static_cast<int>(sum) << " (Expected: " << expected << ")" << std::endl;
+        }
+    }
+    std::cout << name << " : " << (failures ? "FAILED" : "ok") << std::endl;
+    return failures;
+}
+
+int main() {
+    std::mt19937 rng(12345);
+    int failures = 0;
+    failures += check_sequence_sumci("sequence_sumci_kernel_scalar", sequence_sumci_kernel_scalar, rng);
+#ifdef SCHEDULE_KERNELS_X86
+    if (__builtin_cpu_supports("avx2")) failures += check_sequence_sumci("sequence_sumci_kernel_avx2", sequence_sumci_kernel_avx2, rng);
+    else std::cout << "sequence_sumci_kernel_avx2 : skipped (no AVX2)" << std::endl;
+    if (__builtin_cpu_supports("avx512f")) failures += check_sequence_sumci("sequence_sumci_kernel_avx512", sequence_sumci_kernel_avx512, rng);
+    else std::cout << "sequence_sumci_kernel_avx512 : skipped (no AVX-512)" << std::endl;
+#endif
+    failures += check_sequence_sumci("sequence_sumci_kernel", sequence_sumci_kernel, rng);
+
+    failures += check_max_plus_scan("max_plus_scan_scalar", max_plus_scan_block_scalar, max_plus_block_sumci_scalar, rng);
+#ifdef SCHEDULE_KERNELS_X86
+    if (__builtin_cpu_supports("avx2")) failures += check_max_plus_scan("max_plus_scan_avx2", max_plus_scan_block_avx2, max_plus_block_sumci_avx2, rng);
+    else std::cout << "max_plus_scan_avx2 : skipped (no AVX2)" << std::endl;
+    if (__builtin_cpu_supports("avx512f")) failures += check_max_plus_scan("max_plus_scan_avx512", max_plus_scan_block_avx512, max_plus_block_sumci_avx512, rng);
+    else std::cout << "max_plus_scan_avx512 : skipped (no AVX-512)" << std::endl;
+#endif
+    failures += check_max_plus_scan("max_plus_scan", max_plus_scan_block, max_plus_block_sumci, rng);
+    return failures ? 1 : 0;
+}